@@ -0,0 +1,86 @@
+/*
+ * Enemies grouped by the state of their decision tree, for the game
+ * "Chlorine-5". Every state is an archetype of its own: the data of the
+ * thinking and the walking of its enemies is kept there, one array per
+ * component, so a step runs one tight loop per state over contiguous data
+ * instead of an indirect call per enemy in the entities order.
+ * The states only queue their transitions while the enemies think, the
+ * enemies change archetypes after all the loops, in a fixed order.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ecs.hxx"
+#include "enemy.h"
+
+/*what ai_scheduler reads and the states write*/
+struct ai_control {
+    uint32_t phase;    // staggers the thinking steps of the far ones
+    bool thinks;       // in this step, or coasts. Set by ai_scheduler.
+    ai_state next;     // queued by the states
+};
+
+/*where the enemy goes: the hero, and the next cell of the path to it*/
+struct ai_target {
+    CHL::point destination;
+    CHL::point step;
+};
+
+/*the walking, read by coast and apply*/
+struct ai_motion {
+    float alpha;        // the direction of the last think
+    bool moving;
+    bool was_moving;    // moving before the last think
+};
+
+struct ai_timers {
+    float shoot;    // seconds to the reload
+    float find;     // seconds to the next path
+};
+
+/*the shot decided by think, fired by apply*/
+struct ai_shot {
+    bool pending;
+    CHL::point from;
+    float alpha;
+};
+
+typedef ecs::archetype<enemy*, ai_control, ai_target, ai_motion, ai_timers,
+                       ai_shot>
+    ai_bucket;
+
+/*one enemy of a bucket. Valid until an enemy is added, removed or changes
+ * its state.*/
+struct ai_row {
+    enemy* e;
+    ai_control& control;
+    ai_target& target;
+    ai_motion& motion;
+    ai_timers& timers;
+    ai_shot& shot;
+};
+
+class ai_buckets {
+   public:
+    /*to the archetype of its current state, with fresh components*/
+    void add(enemy* e);
+    /*before the enemy is destroyed*/
+    void remove(enemy* e);
+
+    /*move the enemy to the archetype of its queued state, if it is a new
+     * one. The components go with it.*/
+    void apply_transition(enemy* e);
+    /*the same for all of them, in the order given. Serial, between the
+     * thinking passes.*/
+    void apply_transitions(const std::vector<enemy*>& enemies);
+
+    ai_bucket& bucket(ai_state s) { return buckets[static_cast<int>(s)]; }
+
+    ai_row row(ai_state s, size_t i);
+    ai_row row_of(const enemy* e);
+
+   private:
+    ai_bucket buckets[static_cast<int>(ai_state::count)];
+};
@@ -0,0 +1,47 @@
+/*
+ * AI level of detail for the game "Chlorine-5". Enemies around the hero think
+ * every step, the far ones every few steps, and in the steps between they
+ * coast: keep walking the way they went, without paths, sight or decisions.
+ * The thinking steps of the far enemies are staggered by their phase, so the
+ * cost of a step stays flat instead of spiking every few steps.
+ *
+ * The view is a box around the hero, not the camera of the game: a replay
+ * without a window has to make the same decisions.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "engine.hxx"
+#include "global_data.h"
+
+struct lod_rules {
+    /*half of the box around the hero where everybody thinks every step. It
+     * covers the camera of the game (a screen / 8) up to 2560x1440.*/
+    float view_half_width = 12 * TILE_SIZE;
+    float view_half_height = 8 * TILE_SIZE;
+
+    float far_distance = 32 * TILE_SIZE;    // pixels from the hero
+    int near_period = 4;    // steps between thinks, off the view
+    int far_period = 16;    // steps between thinks, beyond far_distance
+};
+
+class ai_scheduler {
+   public:
+    lod_rules rules;
+    bool enabled = true;    // false - everybody thinks every step
+
+    /*set ai_control::thinks, whether the enemy thinks in this step or
+     * coasts. Reads only the enemies and the controls of the archetypes.
+     * Moves to the next step.*/
+    void schedule(ai_buckets& states, const CHL::point& hero);
+
+    /*since the start*/
+    uint64_t thought() const { return thinks_total; }
+    uint64_t coasted() const { return coasts_total; }
+
+   private:
+    uint32_t step = 0;
+    uint64_t thinks_total = 0;
+    uint64_t coasts_total = 0;
+};
@@ -11,11 +11,13 @@
 
 constexpr int default_tileset = 1, default_frame = 1;
 
-void autotile(
-    int** map_grid /*2d map. 1 - wall, 0 - ground*/,
-    CHL::instance*** grid /*2D map of CHL::instance*'s and nullptr's*/,
-    int x_size,
-    int y_size) {
+/*grids are anything indexed as grid[y][x]: plain 2d arrays or grid_rows
+ * views over the level's flat arrays.*/
+template <typename MaskRows, typename InstanceRows>
+void autotile(MaskRows map_grid /*2d map. 1 - wall, 0 - ground*/,
+              InstanceRows grid /*2D map of CHL::instance*'s and nullptr's*/,
+              int x_size,
+              int y_size) {
     for (int y = 0; y < y_size; y++) {
         for (int x = 0; x < x_size; x++) {
             bool left_bonds = x - 1 >= 0;
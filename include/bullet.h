@@ -1,5 +1,7 @@
 /*
- * Bullet base class for the game "Chlorine-5"
+ * Bullet quad for the game "Chlorine-5". Bullets live in bullet_manager as
+ * plain data, this instance is only the quad the manager renders for each of
+ * them.
  */
 #pragma once
 
@@ -9,19 +11,5 @@ enum class bullet_creator { enemy, ally, player, allmighty };
 
 class bullet : public CHL::instance {
    public:
-    int damage;
-    int speed;
-    bullet(float x,
-           float y,
-           float z,
-           int _size_x,
-           int _size_y,
-           int _damage,
-           float _alpha);
-    ~bullet();
-
-    bullet_creator creator = bullet_creator::allmighty;
-
-    /* update every frame */
-    void move(float dt);
+    bullet(float x, float y, float z, int _size_x, int _size_y);
 };
@@ -0,0 +1,93 @@
+/*
+ * Bullet pool for the game "Chlorine-5". Bullets are plain data kept in
+ * parallel arrays of fixed capacity, nothing is allocated while the game runs.
+ * Dead bullets are squeezed out by the passes over the pool, so the live
+ * bullets always take the first size() slots.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "bullet.h"
+#include "collision_grid.h"
+#include "engine.hxx"
+#include "spatial_hash.h"
+
+constexpr float B_LIFETIME = 20.0f;    // seconds
+
+/*what a bullet hit. target is nullptr and target_id is -1 for walls.*/
+struct bullet_hit {
+    CHL::life_form* target;
+    int target_id;    // index in the targets passed to collide()
+    CHL::point point;
+    bullet_creator creator;
+};
+
+/*decides whether the bullet of the creator can hit the target*/
+typedef bool (*bullet_filter)(bullet_creator, CHL::life_form*);
+
+class bullet_manager {
+   public:
+    explicit bullet_manager(size_t capacity);
+
+    /*returns false and drops the bullet if the pool is full*/
+    bool spawn(float x,
+               float y,
+               float alpha,
+               float speed,
+               bullet_creator creator,
+               float lifetime = B_LIFETIME);
+
+    /*move every bullet, drop the ones out of the world or out of time. The
+     * velocity is computed once at spawn, so the whole pass is a few adds and
+     * compares per bullet, four bullets at a time where SSE is available
+     * (define CHL_NO_SIMD to force the scalar loop). Survivors keep their
+     * order.*/
+    void move(float dt);
+
+    /*test the way every bullet made in the last move against the walls and
+     * the hashed targets, the nearest hit wins. Call it after move() and
+     * after the targets moved, so both are tested at the same time. Bullets
+     * that hit something are removed and reported in hits, which is cleared
+     * first.*/
+    void collide(const collision_grid& walls,
+                 const spatial_hash& hash,
+                 const std::vector<CHL::life_form*>& targets,
+                 bullet_filter can_hit,
+                 std::vector<bullet_hit>& hits);
+
+    /*put the bullets seen by the camera into the engine buffer. blend places
+     * them between their positions before (0) and after (1) the last move.*/
+    void render(CHL::engine* eng, CHL::camera* cam, float blend = 1.0f);
+
+    /*move every bullet by (dx, dy), when the level moves under them*/
+    void translate(float dx, float dy);
+
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return count == 0; }
+
+   private:
+    void copy(size_t to, size_t from);
+
+    size_t cap;
+    size_t count = 0;
+
+    std::vector<float> x, y;              // pivot of the quad
+    std::vector<float> prev_x, prev_y;    // pivot before the last move
+    std::vector<float> vx, vy;
+    std::vector<float> alpha;
+    std::vector<float> life;
+    std::vector<bullet_creator> creator;
+
+    /*scratch of collide(), sized once*/
+    std::vector<segment_query> segments;
+    std::vector<collision_hit> wall_hits;
+    std::vector<int> candidates;
+
+    /*one quad rendered for every bullet, created with the first frame*/
+    std::unique_ptr<bullet> proxy;
+};
@@ -0,0 +1,92 @@
+/*
+ * Endless dungeon for the game "Chlorine-5". The world is split into square
+ * chunks and every chunk is generated from (seed, chunk coordinate) only, so a
+ * chunk evicted and generated again is the same chunk. Neighbour chunks share
+ * the gates on their common edge, that is how they are stitched together.
+ * Chunks around the camera are generated on a worker thread, chunks far from
+ * it are evicted, so memory stays bounded wherever the player goes.
+ *
+ * The endless mode of the world plays on a window of chunks stitched together
+ * and moves the window along with the hero, see world.h.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "engine.hxx"
+#include "map.h"
+
+constexpr int CHUNK_SIZE = 32;    // tiles per chunk side
+
+struct chunk_coord {
+    chunk_coord() : x(0), y(0) {}
+    chunk_coord(int _x, int _y) : x(_x), y(_y) {}
+    int x, y;
+
+    bool operator==(const chunk_coord& o) const { return x == o.x && y == o.y; }
+    bool operator<(const chunk_coord& o) const {
+        return x < o.x || (x == o.x && y < o.y);
+    }
+};
+
+struct chunk {
+    chunk_coord coord;
+    Map map;
+};
+
+class chunk_streamer {
+   public:
+    /*radius is the number of chunks kept around the camera chunk*/
+    chunk_streamer(int seed, int radius);
+    ~chunk_streamer();
+
+    chunk_streamer(const chunk_streamer&) = delete;
+    chunk_streamer& operator=(const chunk_streamer&) = delete;
+
+    /*request the chunks around the camera and evict the far ones. Call it
+     * once per frame, it never waits for the generation. The camera looks at
+     * a window of chunks, origin is the top left chunk of it.*/
+    void update(CHL::camera* cam, const chunk_coord& origin);
+    void update(int tile_x, int tile_y);
+
+    /*chunk if it is already generated, nullptr otherwise*/
+    std::shared_ptr<const chunk> get_chunk(const chunk_coord& c) const;
+
+    /*tile at the world tile coordinates. Not generated tiles are Unused.*/
+    Tile get_cell(int x, int y) const;
+
+    size_t resident() const;
+
+    /*map of count x count chunks, first is the top left one. The chunks not
+     * generated yet are generated right here, so the map is the same however
+     * far the worker is.*/
+    Map stitch(const chunk_coord& first, int count) const;
+
+    /*deterministic chunk generation, also used by the worker*/
+    static Map generate_chunk(int seed, const chunk_coord& c);
+
+    static chunk_coord chunk_of(int tile_x, int tile_y);
+
+   private:
+    void work();
+    bool in_range(const chunk_coord& c, int r) const;
+
+    const int seed;
+    const int radius;
+
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    std::deque<chunk_coord> requests;
+    std::set<chunk_coord> pending;
+    std::map<chunk_coord, std::shared_ptr<const chunk>> chunks;
+    chunk_coord center;
+    bool stop = false;
+
+    std::thread worker;
+};
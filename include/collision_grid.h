@@ -0,0 +1,71 @@
+/*
+ * Static collision grid for the game "Chlorine-5". Every wall brick lies
+ * inside its own tile, so a collision test only has to look at the tiles the
+ * tested box overlaps or the tested segment crosses, not at every brick of
+ * the level.
+ */
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "engine.hxx"
+#include "level.h"
+
+/*result of a query, returned by value so nothing is allocated per test*/
+struct collision_hit {
+    bool hit = false;
+    float t = 0.0f;       // segment parameter of the entry
+    CHL::point point;     // entry point
+    CHL::point normal;    // of the entered face, zero if started inside
+    CHL::instance* object = nullptr;
+};
+
+struct segment_query {
+    CHL::point from, to;
+};
+
+/*slab test of the segment from + t * (to - from), t in [0, 1], against the
+ * collision box of the instance*/
+collision_hit segment_hit(const CHL::point& from,
+                          const CHL::point& to,
+                          CHL::instance* box);
+
+class collision_grid {
+   public:
+    /*the grid reads the level's cells, so the level has to outlive it*/
+    explicit collision_grid(const level& lvl);
+
+    /*merged wall boxes overlapped by the collision box of the instance, each
+     * once. Entities resolve against these instead of single bricks.*/
+    void query_walls(CHL::instance* inst,
+                     std::vector<CHL::instance*>& out) const;
+
+    /*walk the tiles along the segment (DDA) and report the first brick the
+     * segment enters. Fast bullets cannot tunnel through walls this way.*/
+    collision_hit sweep(const CHL::point& from, const CHL::point& to) const;
+
+    /*sweep every query, out has to hold count results*/
+    void sweep(const segment_query* queries,
+               size_t count,
+               collision_hit* out) const;
+
+    CHL::instance* brick(int tile_x, int tile_y) const {
+        return cells[tile_y * width + tile_x];
+    }
+
+   private:
+    void tile_range(float left,
+                    float top,
+                    float right,
+                    float bottom,
+                    int& x0,
+                    int& y0,
+                    int& x1,
+                    int& y1) const;
+
+    int width, height;
+    const std::vector<CHL::instance*>& cells;
+    const std::vector<CHL::instance*>& wall_boxes;
+    const std::vector<int>& wall_box_of;
+};
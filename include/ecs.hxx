@@ -0,0 +1,121 @@
+/*
+ * Archetype storage for the game "Chlorine-5". Every entity of an archetype
+ * has the same set of components, and every component type is kept in its
+ * own contiguous array, so a system walks only the arrays it reads. Entities
+ * are rows: removing one moves the last row into its place.
+ */
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ecs {
+
+/*position of T in the list Ts*/
+template <typename T, typename... Ts>
+struct index_of;
+
+template <typename T, typename... Ts>
+struct index_of<T, T, Ts...> {
+    static constexpr size_t value = 0;
+};
+
+template <typename T, typename U, typename... Ts>
+struct index_of<T, U, Ts...> {
+    static constexpr size_t value = 1 + index_of<T, Ts...>::value;
+};
+
+/*compile time 0 .. N - 1, to walk all the columns at once*/
+template <size_t... I>
+struct indices {};
+
+template <size_t N, size_t... I>
+struct make_indices : make_indices<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct make_indices<0, I...> {
+    typedef indices<I...> type;
+};
+
+template <typename... Components>
+class archetype {
+   public:
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void reserve(size_t n) { reserve(n, all()); }
+
+    /*returns the row of the new entity*/
+    size_t add(const Components&... c) {
+        add(all(), c...);
+        return count++;
+    }
+
+    /*the last row moves into the removed one. Walk the rows backwards to
+     * remove while iterating.*/
+    void remove(size_t row) {
+        remove(row, all());
+        count--;
+    }
+
+    void clear() {
+        clear(all());
+        count = 0;
+    }
+
+    template <typename C>
+    std::vector<C>& column() {
+        return std::get<index_of<C, Components...>::value>(columns);
+    }
+
+    template <typename C>
+    const std::vector<C>& column() const {
+        return std::get<index_of<C, Components...>::value>(columns);
+    }
+
+    /*f(Used&...) for every entity, only the Used columns are touched*/
+    template <typename... Used, typename F>
+    void each(F f) {
+        for (size_t i = 0; i < count; i++)
+            f(column<Used>()[i]...);
+    }
+
+   private:
+    typedef typename make_indices<sizeof...(Components)>::type all_indices;
+    static all_indices all() { return all_indices(); }
+
+    /*expands the pack in order, the values are thrown away*/
+    struct swallow {
+        template <typename... T>
+        swallow(T&&...) {}
+    };
+
+    template <size_t... I>
+    void reserve(size_t n, indices<I...>) {
+        swallow{(std::get<I>(columns).reserve(n), 0)...};
+    }
+
+    template <size_t... I>
+    void add(indices<I...>, const Components&... c) {
+        swallow{(std::get<I>(columns).push_back(c), 0)...};
+    }
+
+    template <size_t... I>
+    void remove(size_t row, indices<I...>) {
+        swallow{(std::get<I>(columns)[row] =
+                     std::move(std::get<I>(columns).back()),
+                 std::get<I>(columns).pop_back(), 0)...};
+    }
+
+    template <size_t... I>
+    void clear(indices<I...>) {
+        swallow{(std::get<I>(columns).clear(), 0)...};
+    }
+
+    std::tuple<std::vector<Components>...> columns;
+    size_t count = 0;
+};
+
+}    // namespace ecs
@@ -0,0 +1,70 @@
+/*
+ * Short-lived visual effects of the game "Chlorine-5": explosions where the
+ * bullets hit and the fading copies the player leaves behind while blinking.
+ * They are plain components in archetype storage, nothing is allocated per
+ * effect and the systems below stream through the component arrays.
+ */
+#pragma once
+
+#include <memory>
+
+#include "ecs.hxx"
+#include "engine.hxx"
+
+struct transform {
+    float x, y;
+    int z_index;
+};
+
+/*what part of the texture the quad shows*/
+struct sprite {
+    int size;
+    int frame, frames_in_texture;
+    int tileset, tilesets_in_texture;
+};
+
+/*sprite animation, in seconds so it does not depend on the step rate*/
+struct frame_timer {
+    float delay;          // time left on the current sprite frame
+    float frame_delay;    // time per sprite frame
+};
+
+struct fade {
+    float alpha;    // alpha channel, fades to zero
+};
+
+class effect_world {
+   public:
+    ecs::archetype<transform, sprite, frame_timer> explosions;
+    ecs::archetype<transform, sprite, fade> fades;
+
+    /*explosion centered on the hit point*/
+    void spawn_explosion(float x, float y);
+    /*fading copy of the current look of the instance*/
+    void spawn_fade(const CHL::instance* look);
+
+    /*animation system: step the explosions by dt seconds, drop the played
+     * ones*/
+    void animate(float dt);
+
+    /*render systems. Explosions go in one batch, every fade is drawn on its
+     * own with its alpha and faded afterwards.*/
+    void render_explosions(CHL::engine* eng,
+                           CHL::camera* cam,
+                           CHL::texture* tex);
+    void render_fades(CHL::engine* eng,
+                      CHL::camera* cam,
+                      CHL::texture* tex,
+                      float dt);
+
+    /*move every effect by (dx, dy), when the level moves under them*/
+    void translate(float dx, float dy);
+
+    void clear();
+
+   private:
+    /*load the components into the quad the engine renders*/
+    CHL::instance* quad(const transform& t, const sprite& s);
+
+    std::unique_ptr<CHL::instance> proxy;
+};
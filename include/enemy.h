@@ -3,44 +3,76 @@
  */
 #pragma once
 
+#include <cstddef>
+
 #include "engine.hxx"
+#include "rng.hxx"
+
+/*nodes of the decision tree*/
+enum class ai_state { smart_move, chase, stall, count };
 
+struct ai_row;
+
+/*the data of the thinking and the walking is not here but in the archetype
+ * of the state, see ai_buckets*/
 class enemy : public CHL::life_form {
    public:
     enemy(float x, float y, float z, int _speed, int _size);
     enemy(float x, float y, float z, int _speed, int _size_x, int _size_y);
     virtual ~enemy();
 
-    CHL::point destination;
     CHL::light* visor_light;
 
     int* map;
+    int map_width = 0, map_height = 0;    // tiles of the map
 
-    /*actions*/
+    /*actions. move() is one enemy thinking as a bucket of its own, then
+     * taking its new state and apply().*/
     void move(float) override;
-    void fire();
+
+    /*think or coast the rows [begin, end) of the archetype of state s, one
+     * loop for the state with no indirect calls. Thinking is the decision
+     * tree, the path and the line of sight queries and the own position. It
+     * writes nothing but the enemies of the rows, so the rows can think on
+     * several threads at once. The new states are only queued, ai_buckets
+     * applies them after the loops.*/
+    static void think_bucket(ai_state s, size_t begin, size_t end, float dt);
+
+    /*the level moved by d pixels under the enemy, so do the enemy and the
+     * points it walks and shoots to*/
+    void translate(const CHL::point& d);
+    /*what is shared: the shots, the sounds and the visor light. Serial, in a
+     * fixed order.*/
+    void apply();
 
     /*decision tree states*/
-    friend void chase(enemy*, float dt);
-    friend void stall(enemy*, float dt);
-    friend void smart_move(enemy*, float dt);
-    friend float change_sprite(enemy*);
-    friend void pathfind(enemy*);
+    friend void chase(const ai_row&, float dt);
+    friend void stall(const ai_row&, float dt);
+    friend void smart_move(const ai_row&, float dt);
+    friend float change_sprite(const ai_row&);
+    friend void pathfind(const ai_row&);
+
+    friend void do_actions(const ai_row&, float dt);
 
-    friend void do_actions(enemy*, float dt);
+    friend class ai_buckets;
 
    private:
-    bool moving = false;
-    float shoot_delay = 0.0f;
+    ai_state state = ai_state::smart_move;
+    size_t bucket_slot = 0;    // row in the archetype of the state
 
-    void (*state)(enemy*, float);
+    template <void (*S)(const ai_row&, float)>
+    static void think_loop(ai_state s, size_t begin, size_t end, float dt);
+    static void begin_think(const ai_row& r);
+    static void end_think(const ai_row& r, float dt);
+    /*the cheap step between two thinks: keep walking the way of the last
+     * think, the timers run on. Same rules for the threads as thinking.*/
+    static void coast(const ai_row& r, float dt);
+    static void fire(const ai_row& r);
 
-    CHL::point step_dest;
     CHL::point light_offset;
-    CHL::point shooting_point;
-    float delta_find = 0.0f;
-    float shooting_alpha;
 
     uint32_t fire_source = 0;
     uint32_t steps_source = 0;
+
+    pcg32 rng;    // own stream, for the spread and the sounds
 };
@@ -111,6 +111,10 @@ class engine;
 engine* create_engine();
 void destroy_engine(engine* e);
 
+/*engine that opens no window and renders nothing, for running the game
+ * simulation without a GPU. Delete it when done.*/
+engine* create_null_engine();
+
 /*sometimes you have to know more info about current key*/
 enum class event_type { pressed, released, other };
 
@@ -242,6 +246,7 @@ class life_form : public instance {
     virtual void move(float) = 0;
     int speed;
     int health = 1;
+    int kind = 0;    // type tag set by the game, so it needs no RTTI
     float delta_x = 0, delta_y = 0;
     point velocity_impulse;
 };
@@ -342,6 +347,13 @@ class engine {
     virtual point get_mouse_pos(camera*) = 0;
     virtual void add_object(instance*, camera*) = 0;
     virtual void render(texture*, camera*, instance*) = 0;
+    /*static geometry is kept in named buffers and rendered in one call*/
+    virtual void add_to_buffer(const std::string& key, instance*) = 0;
+    virtual void clear_buffer(const std::string& key) = 0;
+    virtual void render(texture*,
+                        camera*,
+                        instance*,
+                        const std::string& buffer_name) = 0;
     virtual void render_text(const std::string& text,
                              font* f,
                              float x,
@@ -0,0 +1,21 @@
+/*
+ * State the engine core shares with the backends of the CHL engine. Not for
+ * the engine users: the backend sets it up in CHL_init and set_virtual_world,
+ * the core reads it to build the quads.
+ */
+#pragma once
+
+#include <vector>
+
+namespace CHL {
+
+/*simple quad data with texture coordinates*/
+extern std::vector<float> quad_data;
+
+extern int t_size;      // tile size
+extern int w_w, w_h;    // window size
+extern int virtual_w;
+extern int virtual_h;
+extern int FPS;
+
+}    // namespace CHL
@@ -0,0 +1,28 @@
+/*
+ * Frame time statistics for the game "Chlorine-5". Every subsystem keeps the
+ * time it took in every step or frame, and the report at exit gives the mean,
+ * the median, the 99th percentile and the worst of them, to chart how each
+ * subsystem scales with the scenario.
+ */
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+enum class subsystem { ai, collision, bullets, effects, render, count };
+
+class frame_stats {
+   public:
+    /*milliseconds of a steady clock, for measuring*/
+    static double now();
+
+    void add(subsystem s, double ms) {
+        samples[static_cast<int>(s)].push_back(static_cast<float>(ms));
+    }
+
+    /*one line per subsystem that has samples*/
+    void report(std::ostream& out) const;
+
+   private:
+    std::vector<float> samples[static_cast<int>(subsystem::count)];
+};
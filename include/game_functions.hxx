@@ -4,6 +4,7 @@
 #pragma once
 
 #include <math.h>
+#include <algorithm>
 #include "engine.hxx"
 
 /*calculate a precision for better shooting if rotating object relative position
@@ -39,3 +40,17 @@ inline int sign(T val) {
 inline float precise(float value, float precision) {
     return (int)(value / precision) * precision;
 }
+
+/*the collision box of the instance in world coordinates, the box that
+ * check_collision and segment_hit test. Y grows down, position.y is the
+ * bottom of the box.*/
+inline void collision_bounds(const CHL::instance* e,
+                             float& left,
+                             float& top,
+                             float& right,
+                             float& bottom) {
+    left = e->position.x + e->collision_box_offset.x;
+    bottom = e->position.y - e->collision_box_offset.y;
+    right = left + e->collision_box.x;
+    top = bottom - e->collision_box.y;
+}
@@ -4,8 +4,13 @@
 #pragma once
 
 #include "engine.hxx"
-#include "bullet.h"
+#include "ai_buckets.h"
+#include "bullet_manager.h"
+#include "effects.h"
+#include "line_of_sight.h"
 #include "resource_manager.h"
+#include "rng.hxx"
+#include "slot_map.hxx"
 
 #include <string>
 #include <vector>
@@ -18,17 +23,48 @@ constexpr int VIRTUAL_WIDTH = 1024, VIRTUAL_HEIGHT = 640;
 
 constexpr int TILE_SIZE = 16;
 
-constexpr int FPS = 60;
+constexpr int FPS = 60;    // render frames per second, at most
+
+/* the simulation steps at a fixed rate, whatever the render rate is */
+constexpr int TICK_RATE = 120;    // steps per second
 
 constexpr int P_SPEED = 32;
 constexpr int B_SPEED = 100;
 
+constexpr int MAX_BULLETS = 100000;
+
+/* the precomputed visibility table is built only if it fits */
+constexpr size_t VISIBILITY_BUDGET = 4 << 20;    // bytes
+
 constexpr int x_size = VIRTUAL_WIDTH / TILE_SIZE,
               y_size = VIRTUAL_HEIGHT / TILE_SIZE;
 
-extern std::vector<CHL::instance*> non_material_quads;
+/* gameplay numbers a scenario can change */
+struct game_tuning {
+    int speed = P_SPEED;           // hero and enemies, pixels per second
+    int bullet_speed = B_SPEED;    // pixels per second
+    float enemy_shoot_delay = 1.0f;    // seconds between shots
+    float hero_shoot_delay = 0.4f;
+    int enemy_health = 3;
+    int hero_health = 500;
+};
+
+/* life_form::kind values */
+enum class entity_kind { unknown, player, enemy };
+
+inline bool is_kind(const CHL::life_form* lf, entity_kind k) {
+    return lf->kind == static_cast<int>(k);
+}
+
+extern effect_world effects;
 extern std::vector<CHL::instance*> bricks;
-extern std::vector<bullet*> bullets;
-extern std::vector<CHL::life_form*> entities;
+extern bullet_manager bullets;
+extern line_of_sight sight;
+extern int live_enemies;    // enemies constructed and not yet destroyed
+extern int world_width, world_height;    // pixels, set by the world
+extern game_tuning tuning;
+extern slot_map<CHL::life_form*> entities;
 extern CHL::camera* main_camera;
 extern resource_manager manager;
+extern rng_service random_streams;
+extern ai_buckets enemy_states;    // the thinking and walking of the enemies
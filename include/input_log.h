@@ -0,0 +1,89 @@
+/*
+ * Input recording for the game "Chlorine-5". The hero's input is sampled once
+ * per simulation step and only the steps where it changed are written, so a
+ * hero standing still costs nothing. The log keeps the seed and the scenario
+ * of the run, and the world is deterministic for them, so feeding the log
+ * back replays the whole session step by step.
+ *
+ * The file is an input_log_header, an input_log_scenario and the input_record
+ * entries in tick order.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "player.h"
+#include "scenario.h"
+
+constexpr uint32_t INPUT_LOG_MAGIC = 0x49354843;    // "CH5I"
+constexpr uint16_t INPUT_LOG_VERSION = 3;
+
+struct input_log_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t tick_rate;    // steps per second of the recorded run
+    int32_t seed;
+    uint32_t ticks;      // steps recorded
+    uint32_t records;    // input_record entries that follow
+    uint32_t reserved;
+};
+
+/*the scenario keys that change the run, the seed is in the header*/
+struct input_log_scenario {
+    int32_t map_width, map_height;
+    int32_t enemies;
+    int32_t threads;    // the run does not depend on it, it is a default
+    int32_t ai_lod;
+    int32_t endless;
+    int32_t speed, bullet_speed;
+    float enemy_shoot_delay, hero_shoot_delay;
+    int32_t enemy_health, hero_health;
+};
+
+/*input of the hero from the tick on, until the next record*/
+struct input_record {
+    uint32_t tick;
+    uint32_t keys;    // bit i is hero->keys[i]
+    float cursor_x, cursor_y;
+};
+
+class input_recorder {
+   public:
+    /*sample the hero's input for the step about to be made*/
+    void record(const player* hero);
+
+    uint32_t ticks() const { return tick; }
+
+    /*returns false and logs the reason if the file cannot be written*/
+    bool save(const std::string& path, const scenario& s, int tick_rate) const;
+
+   private:
+    uint32_t tick = 0;
+    std::vector<input_record> records;
+};
+
+class input_replay {
+   public:
+    /*returns false and logs the reason if the file is missing or broken*/
+    bool load(const std::string& path);
+
+    int seed() const { return header.seed; }
+    /*the recorded scenario with the seed, the duration is not recorded*/
+    const scenario& recorded() const { return played; }
+    int tick_rate() const { return header.tick_rate; }
+    uint32_t ticks() const { return header.ticks; }
+
+    /*give the hero the recorded input of the next step. Returns false when
+     * every recorded step is replayed.*/
+    bool apply(player* hero);
+
+   private:
+    input_log_header header = input_log_header();
+    scenario played;
+    std::vector<input_record> records;
+    uint32_t tick = 0;
+    size_t next = 0;    // first record not applied yet
+};
@@ -0,0 +1,66 @@
+/*
+ * Work-stealing job system for the game "Chlorine-5". Every thread has its
+ * own deque of jobs: it takes work from the back of its deque and, when the
+ * deque is empty, steals from the front of another one. A parallel_for job
+ * splits itself in halves until it is small enough, so an idle thread always
+ * steals the biggest piece left.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class job_system {
+   public:
+    /*threads counts the calling thread too, 0 takes one per core and 1 runs
+     * everything on the caller*/
+    explicit job_system(int threads = 0);
+    ~job_system();
+
+    job_system(const job_system&) = delete;
+    job_system& operator=(const job_system&) = delete;
+
+    /*body(begin, end) for disjoint ranges covering [0, count), at most grain
+     * long. Returns when all of them are done, the caller works too. Ranges
+     * run in any order on any thread.*/
+    void parallel_for(size_t count,
+                      size_t grain,
+                      const std::function<void(size_t, size_t)>& body);
+
+    int threads() const { return static_cast<int>(queues.size()); }
+
+   private:
+    struct job {
+        size_t begin, end;
+    };
+
+    struct job_queue {
+        std::mutex lock;
+        std::deque<job> jobs;
+    };
+
+    void work(int id);
+    bool find_job(int id, job& out);
+    void run(int id, job j);
+
+    /*one queue per thread, the caller has queue 0*/
+    std::vector<std::unique_ptr<job_queue>> queues;
+    std::vector<std::thread> workers;
+
+    /*the current parallel_for*/
+    const std::function<void(size_t, size_t)>* body = nullptr;
+    size_t grain = 1;
+    std::atomic<size_t> unfinished{0};
+
+    std::mutex lock;
+    std::condition_variable wake;
+    unsigned generation = 0;    // bumped by every parallel_for
+    bool stop = false;
+};
@@ -0,0 +1,47 @@
+/*
+ * Level of the game "Chlorine-5". Everything the runtime needs from the
+ * generated map is built here by one pass over the packed tiles.
+ */
+#pragma once
+
+#include <vector>
+
+#include "engine.hxx"
+#include "map.h"
+
+/*row access to a flat grid, so it can be indexed as grid[y][x]*/
+template <typename T>
+struct grid_rows {
+    T* data;
+    int width;
+
+    T* operator[](int y) const { return data + y * width; }
+};
+
+/*all grids are row-major, width * height cells*/
+struct level {
+    int width = 0, height = 0;
+
+    std::vector<int> walls;       // 1 - wall, 0 - ground
+    std::vector<int> walkable;    // pathfinders map, nonzero is passable
+    std::vector<CHL::instance*> cells;    // brick of the cell or nullptr
+    std::vector<int> free_cells;          // walkable cell indices, ascending
+
+    /*render tiles, already autotiled*/
+    std::vector<CHL::instance*> bricks;
+    std::vector<CHL::instance*> floor;
+
+    /*wall tiles merged into maximal rectangles, collision only. Full tiles
+     * and half-height top walls are never merged together.*/
+    std::vector<CHL::instance*> wall_boxes;
+    std::vector<int> wall_box_of;    // wall_boxes index of the cell or -1
+};
+
+/*build the level from the map. Instances are owned by the level user. The
+ * top left tile of the map is the world tile (origin_x, origin_y): the endless
+ * level is a window that moves, and a floor tile looks the same wherever the
+ * window is.*/
+void build_level(const Map& map,
+                 level& lvl,
+                 int origin_x = 0,
+                 int origin_y = 0);
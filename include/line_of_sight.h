@@ -0,0 +1,63 @@
+/*
+ * Line of sight for the game "Chlorine-5". Visibility is traced over the
+ * pathfinder map tile by tile instead of testing every brick of the level,
+ * and the answers are cached for one frame: enemies standing on the same tile
+ * and looking at the same player tile share one trace. Every cached answer is
+ * one atomic word, so the enemies can query from several threads at once.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "engine.hxx"
+
+class visibility_table;
+
+class line_of_sight {
+   public:
+    /*cache_size has to be a power of two*/
+    explicit line_of_sight(int cache_size = 1024);
+
+    /*the map is the pathfinder one (nonzero is passable), row-major. It is
+     * not copied, so it has to outlive the queries.*/
+    void set_map(const int* walkable, int width, int height);
+
+    /*forget the answers of the previous frame. Not thread safe, call it
+     * between the frames.*/
+    void new_frame();
+
+    /*true if the line between the centers of the tiles crosses passable
+     * tiles only. A line going exactly through a tile corner needs both
+     * tiles beside the corner to be passable. Not cached.*/
+    bool trace(int from_x, int from_y, int to_x, int to_y) const;
+
+    /*visibility between the tiles of the points in world coordinates,
+     * cached for the current frame, or read from the table if there is one.
+     * Thread safe.*/
+    bool visible(const CHL::point& from, const CHL::point& to);
+
+    /*answer from the precomputed table instead of tracing, nullptr turns
+     * tracing back on. The table has to be built for the same map.*/
+    void set_table(const visibility_table* t) { table = t; }
+
+    bool passable(int x, int y) const {
+        return x >= 0 && y >= 0 && x < width && y < height &&
+               map[y * width + x] != 0;
+    }
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+
+   private:
+    const int* map = nullptr;
+    int width = 0, height = 0;
+    const visibility_table* table = nullptr;
+
+    /*open addressing, a slot is empty unless it was written this frame. A
+     * slot packs the two tiles (24 bits each), the frame stamp (15 bits) and
+     * the answer (the lowest bit), so it is written and read at once.*/
+    std::vector<std::atomic<uint64_t>> cache;
+    uint32_t mask;
+    uint32_t stamp = 1;
+};
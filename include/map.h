@@ -0,0 +1,197 @@
+/*
+ * Dungeon map for the game "Chlorine-5". Filled by the DungeonGenerator,
+ * saved and loaded by the map file functions.
+ */
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+enum class Tile : uint8_t {
+    Unused,
+    DirtWall,
+    DirtFloor,
+    Corridor,
+    Door,
+    UpStairs,
+    DownStairs
+};
+
+enum class Direction {
+    North,
+    South,
+    East,
+    West,
+};
+
+/*Tiles are packed by 4 bits, 16 tiles into one 64-bit word (tile x of the
+ * word sits in bits 4 * x .. 4 * x + 3), every row starts with a new word.
+ * Padding tiles at the end of a row are always Unused. This is the same layout
+ * as in the map file, so rows can be saved and loaded as they are.*/
+class Map {
+   public:
+    Map() : xSize(0), ySize(0), rowWords(0), data() {}
+
+    Map(int x, int y, Tile value = Tile::Unused)
+        : xSize(x), ySize(y), rowWords((x + 15) / 16), data(rowWords * y, 0) {
+        if (value != Tile::Unused)
+            SetCells(0, 0, x - 1, y - 1, value);
+    }
+
+    /*build the map from rows packed in the layout above*/
+    Map(int x, int y, const uint64_t* rows)
+        : xSize(x), ySize(y), rowWords((x + 15) / 16), data(rowWords * y) {
+        std::memcpy(data.data(), rows, data.size() * sizeof(uint64_t));
+    }
+
+    void SetCell(int x, int y, Tile celltype) {
+        assert(IsXInBounds(x));
+        assert(IsYInBounds(y));
+
+        uint64_t& word = data[y * rowWords + x / 16];
+        int shift = 4 * (x % 16);
+        word = (word & ~(uint64_t(0xF) << shift)) |
+               (static_cast<uint64_t>(celltype) << shift);
+    }
+
+    Tile GetCell(int x, int y) const {
+        assert(IsXInBounds(x));
+        assert(IsYInBounds(y));
+
+        return Nibble(x, y);
+    }
+
+    /*fills the rectangle row by row, a whole word (16 tiles) at a time*/
+    void SetCells(int xStart, int yStart, int xEnd, int yEnd, Tile cellType) {
+        assert(IsXInBounds(xStart) && IsXInBounds(xEnd));
+        assert(IsYInBounds(yStart) && IsYInBounds(yEnd));
+
+        assert(xStart <= xEnd);
+        assert(yStart <= yEnd);
+
+        const uint64_t pattern = Pattern(cellType);
+        for (auto y = yStart; y != yEnd + 1; ++y) {
+            uint64_t* row = &data[y * rowWords];
+            for (int w = xStart / 16; w <= xEnd / 16; w++) {
+                uint64_t mask = SpanMask(w, xStart, xEnd);
+                row[w] = (row[w] & ~mask) | (pattern & mask);
+            }
+        }
+    }
+
+    int GetXSize() const { return xSize; }
+
+    int GetYSize() const { return ySize; }
+
+    /*packed words of one row, GetRowWords() of them*/
+    const uint64_t* GetRow(int y) const { return &data[y * rowWords]; }
+
+    int GetRowWords() const { return rowWords; }
+
+    bool IsXInBounds(int x) const { return x >= 0 && x < xSize; }
+
+    bool IsYInBounds(int y) const { return y >= 0 && y < ySize; }
+
+    /*Unused is zero, so the area is unused when all its nibbles are zero*/
+    bool IsAreaUnused(int xStart, int yStart, int xEnd, int yEnd) const {
+        assert(IsXInBounds(xStart) && IsXInBounds(xEnd));
+        assert(IsYInBounds(yStart) && IsYInBounds(yEnd));
+
+        assert(xStart <= xEnd);
+        assert(yStart <= yEnd);
+
+        for (auto y = yStart; y != yEnd + 1; ++y) {
+            const uint64_t* row = &data[y * rowWords];
+            for (int w = xStart / 16; w <= xEnd / 16; w++)
+                if (row[w] & SpanMask(w, xStart, xEnd))
+                    return false;
+        }
+
+        return true;
+    }
+
+    bool IsAdjacent(int x, int y, Tile tile) const {
+        assert(IsXInBounds(x - 1) && IsXInBounds(x + 1));
+        assert(IsYInBounds(y - 1) && IsYInBounds(y + 1));
+
+        const uint64_t pattern = Pattern(tile);
+        const int w = x / 16;
+        const int shift = 4 * (x % 16);
+
+        /*the tiles above and below share the word index, test them at once*/
+        uint64_t vertical = Matches(data[(y - 1) * rowWords + w], pattern) |
+                            Matches(data[(y + 1) * rowWords + w], pattern);
+        if ((vertical >> shift) & 1)
+            return true;
+
+        /*left and right neighbours, usually in the same word as the tile*/
+        const uint64_t* row = &data[y * rowWords];
+        uint64_t left = Matches(row[(x - 1) / 16], pattern);
+        uint64_t right = Matches(row[(x + 1) / 16], pattern);
+        return ((left >> (4 * ((x - 1) % 16))) & 1) ||
+               ((right >> (4 * ((x + 1) % 16))) & 1);
+    }
+
+    /*walkable bit-plane: one bit per tile, 64 tiles per word, every row starts
+     * with a new word. Everything except Unused and DirtWall is walkable.*/
+    std::vector<uint64_t> WalkableBits() const {
+        const int bitWords = (xSize + 63) / 64;
+        std::vector<uint64_t> bits(bitWords * ySize, 0);
+
+        for (int y = 0; y < ySize; y++) {
+            const uint64_t* row = &data[y * rowWords];
+            uint64_t* out = &bits[y * bitWords];
+            for (int w = 0; w < rowWords; w++)
+                out[w / 4] |= Compress(Walkable(row[w])) << (16 * (w % 4));
+        }
+        return bits;
+    }
+
+   private:
+    int xSize, ySize;
+    int rowWords;
+
+    std::vector<uint64_t> data;
+
+    static constexpr uint64_t Nibbles = 0x1111111111111111ULL;
+
+    Tile Nibble(int x, int y) const {
+        return static_cast<Tile>(
+            (data[y * rowWords + x / 16] >> (4 * (x % 16))) & 0xF);
+    }
+
+    /*the tile repeated in all 16 nibbles of the word*/
+    static uint64_t Pattern(Tile tile) {
+        return Nibbles * static_cast<uint64_t>(tile);
+    }
+
+    /*nibbles of the word w, which lie inside [xStart, xEnd]*/
+    static uint64_t SpanMask(int w, int xStart, int xEnd) {
+        int first = xStart > w * 16 ? xStart - w * 16 : 0;
+        int last = xEnd < w * 16 + 15 ? xEnd - w * 16 : 15;
+        uint64_t high = last == 15 ? ~0ULL : (1ULL << (4 * (last + 1))) - 1;
+        return high & ~((1ULL << (4 * first)) - 1);
+    }
+
+    /*lowest bit of every nibble is set where the word equals the pattern*/
+    static uint64_t Matches(uint64_t word, uint64_t pattern) {
+        uint64_t v = word ^ pattern;
+        return ~(v | v >> 1 | v >> 2 | v >> 3) & Nibbles;
+    }
+
+    /*lowest bit of every nibble is set for walkable tiles (value >= 2)*/
+    static uint64_t Walkable(uint64_t word) {
+        return (word >> 1 | word >> 2 | word >> 3) & Nibbles;
+    }
+
+    /*gather the lowest bits of the 16 nibbles into 16 contiguous bits*/
+    static uint64_t Compress(uint64_t t) {
+        t = (t | t >> 3) & 0x0303030303030303ULL;
+        t = (t | t >> 6) & 0x000F000F000F000FULL;
+        t = (t | t >> 12) & 0x000000FF000000FFULL;
+        t = (t | t >> 24) & 0xFFFFULL;
+        return t;
+    }
+};
@@ -0,0 +1,92 @@
+/*
+ * Compact binary map format for the game "Chlorine-5".
+ *
+ * The file is a map_file_header followed by the tile grid. Every tile takes 4
+ * bits, 16 tiles are packed into one little-endian 64-bit word (tile x of the
+ * word sits in bits 4 * x .. 4 * x + 3) and every row is padded to a whole
+ * number of words. The header is 8-byte sized, so the words of the grid stay
+ * aligned in the mapped file: mapped_map decodes tiles right from the mapping,
+ * and to_map() copies the packed words into a Map as they are, without
+ * unpacking them.
+ *
+ * Header fields and tile words are read in place, in the byte order of the
+ * host, so only little-endian hosts are supported.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "map.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "map files are little-endian and read in place, the host has to be too"
+#endif
+
+constexpr uint32_t MAP_FILE_MAGIC = 0x354c4843;    // "CHL5"
+constexpr uint16_t MAP_FILE_VERSION = 1;
+constexpr uint16_t MAP_FILE_TILE_BITS = 4;
+
+struct map_file_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t tile_bits;
+    int32_t seed;
+    int32_t x_size;
+    int32_t y_size;
+    uint32_t row_words;    // 64-bit words per row
+};
+
+/*number of 64-bit words to hold one packed row of the given width*/
+inline uint32_t map_file_row_words(int x_size) {
+    return (x_size + 15) / 16;
+}
+
+/*write the map with the seed it was generated from. Returns false and logs
+ * the reason if the file cannot be written.*/
+bool write_map_file(const std::string& path, const Map& map, int seed);
+
+/*read-only view of the map file. The file is mapped into memory and tiles are
+ * decoded on access, nothing is copied on open.*/
+class mapped_map {
+   public:
+    mapped_map();
+    explicit mapped_map(const std::string& path);
+    ~mapped_map();
+
+    mapped_map(const mapped_map&) = delete;
+    mapped_map& operator=(const mapped_map&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return header != nullptr; }
+
+    int seed() const { return header->seed; }
+    int x_size() const { return header->x_size; }
+    int y_size() const { return header->y_size; }
+
+    Tile get_cell(int x, int y) const {
+        uint64_t word = rows[y * header->row_words + x / 16];
+        return static_cast<Tile>((word >> (4 * (x % 16))) & 0xF);
+    }
+
+    /*copy the whole grid into the regular map*/
+    Map to_map() const;
+
+   private:
+    /*every tile is one of the Tile values, the SWAR masks of Map rely on it*/
+    bool valid_tiles() const;
+
+    const map_file_header* header = nullptr;
+    const uint64_t* rows = nullptr;
+
+    void* view = nullptr;
+    size_t view_size = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#else
+    int file_descriptor = -1;
+#endif
+};
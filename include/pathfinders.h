@@ -3,14 +3,15 @@
 
 #include <vector>
 
+#include "rng.hxx"
+
 using namespace std;
 
-extern int ExploredNodes;
+/*per thread, searches can run on several threads at once*/
+extern thread_local int ExploredNodes;
 extern vector<int> Landmarks;
 extern vector<vector<int>> LD;
 
-void convert2d_array(int** map, int* return_map, int x_size, int y_size);
-
 int BFSFindPath(const int nStartX,
                 const int nStartY,
                 const int nTargetX,
@@ -52,9 +53,10 @@ int AStarFindPathDiag(const int nStartX,
                       const int nOutBufferSize);
 
 void InitializeLandmarks(int k,
-                         const unsigned char* pMap,
+                         const int* pMap,
                          const int nMapWidth,
-                         const int nMapHeight);
+                         const int nMapHeight,
+                         pcg32& rng);
 
 int AStarFindPathLandmarks(const int nStartX,
                            const int nStartY,
@@ -69,7 +71,8 @@ int AStarFindPathLandmarks(const int nStartX,
 void InitializeLandmarksDiag(int k,
                              const int* pMap,
                              const int nMapWidth,
-                             const int nMapHeight);
+                             const int nMapHeight,
+                             pcg32& rng);
 
 int AStarFindPathLandmarksDiag(const int nStartX,
                                const int nStartY,
@@ -0,0 +1,96 @@
+/*
+ * Random numbers for the game "Chlorine-5". Every system, and every entity
+ * that needs it, draws from its own stream derived from the level seed. The
+ * same seed replays the same run bit for bit, and streams share no state, so
+ * systems updated on different threads do not fight over one generator.
+ */
+#pragma once
+
+#include <cstdint>
+
+/*PCG32 (XSH RR) by M. E. O'Neill: 64-bit state, 32-bit output. Generators
+ * of different streams give different sequences for the same seed.*/
+class pcg32 {
+   public:
+    typedef uint32_t result_type;
+
+    pcg32() : pcg32(0, 0) {}
+    pcg32(uint64_t seed, uint64_t stream) : state(0), inc((stream << 1) | 1) {
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rot = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    /*uniform in [0, n), without the modulo bias. n > 0.*/
+    uint32_t below(uint32_t n) {
+        uint32_t threshold = (0u - n) % n;
+        for (;;) {
+            uint32_t r = next();
+            if (r >= threshold)
+                return r % n;
+        }
+    }
+
+    /*uniform in [min, max]*/
+    int range(int min, int max) {
+        uint32_t span = static_cast<uint32_t>(max - min) + 1;
+        return min + static_cast<int>(below(span));
+    }
+
+    /*uniform in [0, 1)*/
+    float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+    /*so it can drive the standard algorithms too*/
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFF; }
+    result_type operator()() { return next(); }
+
+   private:
+    uint64_t state;
+    uint64_t inc;    // odd, selects the stream
+};
+
+/*systems that draw random numbers, every one has its own streams*/
+enum class rng_system { level, spawns, landmarks, enemies, count };
+
+class rng_service {
+   public:
+    /*every stream is derived from the seed, it restarts the entity streams*/
+    void seed(uint64_t level_seed) {
+        base = level_seed;
+        for (uint64_t& c : issued)
+            c = 0;
+    }
+
+    /*the same seed, system and id always give the same numbers*/
+    pcg32 stream(rng_system system, uint64_t id = 0) const {
+        uint64_t key = mix((static_cast<uint64_t>(system) << 48) ^ id);
+        return pcg32(mix(base ^ key), key);
+    }
+
+    /*stream of the next entity of the system. Entities are created in the
+     * same order in every run of a seed, so each gets the same stream.*/
+    pcg32 next_stream(rng_system system) {
+        return stream(system, issued[static_cast<int>(system)]++);
+    }
+
+   private:
+    /*splitmix64 finalizer, spreads close ids over the whole range*/
+    static uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t base = 0;
+    uint64_t issued[static_cast<int>(rng_system::count)] = {};
+};
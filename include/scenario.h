@@ -0,0 +1,51 @@
+/*
+ * Stress scenarios for the game "Chlorine-5": the map size, the seed, the
+ * enemy count, the fire rates and the length of the run. A scenario is read
+ * from a config file of "key = value" lines ('#' starts a comment) and from
+ * the command line as "--key value", the command line wins. "--config file"
+ * loads the file right there.
+ *
+ * keys: map_width, map_height (tiles, at least MIN_MAP_WIDTH x
+ *       MIN_MAP_HEIGHT), seed (0 - a new dungeon every run),
+ *       enemies, duration (seconds of the simulation, 0 runs until the game
+ *       ends), threads (of the enemy AI, 0 - one per core), ai_lod (0 - all
+ *       the enemies think every step), endless (1 - the dungeon has no end,
+ *       map_width and map_height do not matter), speed, bullet_speed,
+ *       enemy_shoot_delay, hero_shoot_delay, enemy_health, hero_health
+ */
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "global_data.h"
+
+/*the first room of the dungeon, up to 8x6 tiles with its walls, grows from
+ * the middle of the map in any direction. It always fits from this size.*/
+constexpr int MIN_MAP_WIDTH = 17, MIN_MAP_HEIGHT = 13;
+
+struct scenario {
+    int map_width = x_size;
+    int map_height = y_size;
+    int seed = 0;    // 0 - a new dungeon every run
+    int enemies = 5;
+    float duration = 0.0f;
+    int threads = 0;    // for the enemy AI, 0 - one per core
+    bool ai_lod = true;    // far enemies think less often
+    bool endless = false;    // chunks streamed around the hero
+    game_tuning tuning;
+
+    /*returns false and logs the reason for an unknown key or a bad value*/
+    bool set(const std::string& key, const std::string& value);
+    bool load(const std::string& path);
+
+    /*options are consumed, everything else goes to positional in order*/
+    bool parse(int argc, char* argv[], std::vector<std::string>& positional);
+
+    /*everything but the duration and the threads is the same, so is the
+     * run*/
+    bool same_run(const scenario& other) const;
+
+    void print(std::ostream& out) const;
+};
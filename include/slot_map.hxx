@@ -0,0 +1,123 @@
+/*
+ * Slot map for the game "Chlorine-5". Values are kept densely packed for
+ * iteration, and every value is reached from outside through a handle: a
+ * slot index plus the generation of the slot. Erasing moves the last value
+ * into the hole (O(1)) and bumps the generation, so an old handle is detected
+ * as stale instead of pointing at whatever took the place.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+struct slot_handle {
+    uint32_t index = 0;
+    uint32_t generation = 0;    // 0 is never issued, so slot_handle() is null
+
+    bool operator==(const slot_handle& o) const {
+        return index == o.index && generation == o.generation;
+    }
+    bool operator!=(const slot_handle& o) const { return !(*this == o); }
+};
+
+template <typename T>
+class slot_map {
+   public:
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    slot_handle insert(const T& value) {
+        uint32_t index;
+        if (free_slots.empty()) {
+            index = slots.size();
+            slots.push_back(slot());
+        } else {
+            index = free_slots.back();
+            free_slots.pop_back();
+        }
+
+        slot& s = slots[index];
+        s.dense = values.size();
+        values.push_back(value);
+        dense_slot.push_back(index);
+
+        slot_handle h;
+        h.index = index;
+        h.generation = s.generation;
+        return h;
+    }
+
+    bool alive(slot_handle h) const {
+        return h.index < slots.size() &&
+               slots[h.index].generation == h.generation &&
+               slots[h.index].dense != NONE;
+    }
+
+    /*nullptr if the handle is stale*/
+    T* get(slot_handle h) {
+        return alive(h) ? &values[slots[h.index].dense] : nullptr;
+    }
+    const T* get(slot_handle h) const {
+        return alive(h) ? &values[slots[h.index].dense] : nullptr;
+    }
+
+    /*the last value moves into the hole, so erasing while iterating skips
+     * it. Returns false for a stale handle.*/
+    bool erase(slot_handle h) {
+        if (!alive(h))
+            return false;
+
+        slot& s = slots[h.index];
+        uint32_t hole = s.dense;
+        uint32_t last = values.size() - 1;
+        if (hole != last) {
+            values[hole] = std::move(values[last]);
+            dense_slot[hole] = dense_slot[last];
+            slots[dense_slot[hole]].dense = hole;
+        }
+        values.pop_back();
+        dense_slot.pop_back();
+
+        s.dense = NONE;
+        if (++s.generation == 0)    // keep 0 for the null handle
+            s.generation = 1;
+        free_slots.push_back(h.index);
+        return true;
+    }
+
+    /*handle of the value at the dense position*/
+    slot_handle handle_of(size_t i) const {
+        slot_handle h;
+        h.index = dense_slot[i];
+        h.generation = slots[h.index].generation;
+        return h;
+    }
+
+    /*dense values, in no particular order*/
+    const std::vector<T>& data() const { return values; }
+    T& operator[](size_t i) { return values[i]; }
+    const T& operator[](size_t i) const { return values[i]; }
+
+    iterator begin() { return values.begin(); }
+    iterator end() { return values.end(); }
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end() const { return values.end(); }
+
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+
+   private:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+    struct slot {
+        uint32_t dense = NONE;
+        uint32_t generation = 1;
+    };
+
+    std::vector<T> values;
+    std::vector<uint32_t> dense_slot;    // slot of every dense value
+    std::vector<slot> slots;
+    std::vector<uint32_t> free_slots;
+};
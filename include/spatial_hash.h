@@ -0,0 +1,66 @@
+/*
+ * Uniform spatial hash for the game "Chlorine-5". Broadphase for the moving
+ * objects: boxes are added once per frame, sorted into hashed cells by a
+ * counting sort (linear in the number of boxes), and queries return only the
+ * ids of the boxes from the cells around the query box.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "engine.hxx"
+
+class spatial_hash {
+   public:
+    /*table_size has to be a power of two*/
+    spatial_hash(float cell_size, int table_size);
+
+    /*forget the boxes of the previous frame*/
+    void clear();
+
+    /*id is any small non-negative number, usually an index in the caller's
+     * array. Boxes are in world coordinates.*/
+    void add(int id, float left, float top, float right, float bottom);
+    /*the collision box, the same box the narrowphase tests. Add the
+     * instance after its last move of the frame.*/
+    void add(int id, const CHL::instance* inst);
+
+    /*sort the added boxes into the cells. Call it after the last add().*/
+    void build();
+
+    /*ids of the boxes sharing a cell with the query box, each id once and in
+     * ascending order. Hash collisions can add a few far ids, so the
+     * narrowphase check is still needed. out is cleared first.*/
+    void query(float left,
+               float top,
+               float right,
+               float bottom,
+               std::vector<int>& out) const;
+
+   private:
+    struct entry {
+        int id;
+        uint32_t slot;
+    };
+
+    uint32_t slot_of(int cell_x, int cell_y) const;
+    void cell_range(float left,
+                    float top,
+                    float right,
+                    float bottom,
+                    int& x0,
+                    int& y0,
+                    int& x1,
+                    int& y1) const;
+
+    float cell_size;
+    uint32_t mask;
+
+    std::vector<entry> entries;    // (id, slot) pairs added this frame
+    std::vector<int> starts;       // first item of every slot, table + 1
+    std::vector<int> items;        // ids sorted by slot
+
+    mutable std::vector<uint32_t> visited;    // per id, query stamp
+    mutable uint32_t stamp = 0;
+};
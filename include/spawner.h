@@ -0,0 +1,63 @@
+/*
+ * Spawn placement for the game "Chlorine-5". Picks free cells of the level
+ * without retrying random positions. The free cells are sorted by the path
+ * distance from the hero once, per room and for the whole level, so the cells
+ * far enough are always a prefix of a list and a spawn costs O(1).
+ */
+#pragma once
+
+#include <vector>
+
+#include "level.h"
+#include "map.h"
+#include "rng.hxx"
+
+struct spawn_rules {
+    int min_distance = 8;          // path distance from the hero, in tiles
+    bool different_rooms = true;   // spread the spawns over the rooms
+    bool allow_corridors = false;  // corridors, doors and stairs
+};
+
+class spawner {
+   public:
+    spawner(const Map& map, const level& lvl);
+
+    /*rebuild the distance field from the hero's tile and sort the cells by
+     * it, O(free cells)*/
+    void set_hero(int tile_x, int tile_y);
+
+    /*up to n cells (row-major indices) matching the rules. With
+     * different_rooms every room gets one spawn before any room gets the
+     * second. Returned cells are taken and never returned again. Costs
+     * O(n + rooms * log(cells)), whatever the level size.*/
+    std::vector<int> sample(int n, const spawn_rules& rules, pcg32& rng);
+
+    /*path distance from the hero, -1 if the cell cannot be reached*/
+    int distance(int cell) const { return dist[cell]; }
+
+    /*room of the cell, -1 for corridors, doors, stairs and walls*/
+    int room(int cell) const { return room_of[cell]; }
+
+    int rooms() const { return room_count; }
+
+   private:
+    int width, height;
+    int room_count = 0;
+
+    const std::vector<int>& free_cells;
+    const std::vector<int>& walkable;
+
+    std::vector<int> room_of;
+    std::vector<int> dist;
+    std::vector<char> taken;
+
+    /*cells by distance from the hero, the farthest first. The unreachable
+     * ones (-1) are at the end.*/
+    std::vector<std::vector<int>> room_cells;    // one list per room
+    std::vector<int> corridor_cells;    // outside the rooms
+    std::vector<int> all_room_cells;
+    std::vector<int> all_cells;
+
+    /*cells of the list at least min_distance far*/
+    size_t far_enough(const std::vector<int>& cells, int min_distance) const;
+};
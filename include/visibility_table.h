@@ -0,0 +1,45 @@
+/*
+ * Precomputed visibility for the game "Chlorine-5". The dungeon does not
+ * change after it is generated, so every passable tile can keep a bitset of
+ * the passable tiles it sees, and a line of sight check becomes one bit test.
+ * The table takes passable^2 bits, so it is meant for the maps where that
+ * fits the memory budget.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "line_of_sight.h"
+
+class visibility_table {
+   public:
+    /*bytes the table takes for the map of the sight*/
+    static size_t estimate(const line_of_sight& sight);
+
+    /*trace every pair of passable tiles of the sight's map. Rows are split
+     * between the threads, 0 threads means one per hardware thread.*/
+    void build(const line_of_sight& sight, int threads = 0);
+
+    /*both tiles have to be passable*/
+    bool visible(int from_x, int from_y, int to_x, int to_y) const {
+        int from = index[from_y * width + from_x];
+        int to = index[to_y * width + to_x];
+        return (bits[from * row_words + to / 64] >> (to % 64)) & 1;
+    }
+
+    bool empty() const { return bits.empty(); }
+    int tiles() const { return count; }
+    size_t memory() const {
+        return bits.size() * sizeof(uint64_t) + index.size() * sizeof(int);
+    }
+
+   private:
+    int width = 0;
+    int count = 0;        // passable tiles
+    int row_words = 0;    // 64-bit words per bitset
+
+    std::vector<int> index;         // compact number of every passable tile
+    std::vector<uint64_t> bits;     // count bitsets, row_words each
+};
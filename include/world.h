@@ -0,0 +1,120 @@
+/*
+ * Simulation of the game "Chlorine-5": the level, the hero, the enemies and
+ * the bullets, stepped in time. Nothing here draws. The game renders the world
+ * after every step, the headless driver does not render it at all.
+ *
+ * The endless mode plays on a window of streamed chunks that moves with the
+ * hero. Positions are always relative to the window, so they stay small
+ * however far the hero goes.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ai_scheduler.h"
+#include "bullet_manager.h"
+#include "chunk_streamer.h"
+#include "collision_grid.h"
+#include "engine.hxx"
+#include "frame_stats.h"
+#include "job_system.h"
+#include "level.h"
+#include "map.h"
+#include "player.h"
+#include "rng.hxx"
+#include "slot_map.hxx"
+#include "spatial_hash.h"
+#include "spawner.h"
+#include "visibility_table.h"
+
+/*side of the endless level in chunks, the hero is kept in the middle one*/
+constexpr int WINDOW_CHUNKS = 3;
+
+/*chunks to stream around the camera in the endless mode: the window and the
+ * ring it moves into next*/
+constexpr int STREAM_RADIUS = WINDOW_CHUNKS / 2 + 1;
+
+class world {
+   public:
+    /*build the level and place the hero and the enemies. They go to the
+     * global entities, so only one world can live at a time. All the
+     * randomness of the run comes from the seed, the number of threads
+     * thinking for the enemies changes nothing but the speed (0 - one per
+     * core). Throws std::runtime_error if the map has no free cell for the
+     * hero.*/
+    world(const Map& map, uint64_t seed, int enemy_count = 5, int threads = 0);
+
+    /*endless mode: the level is a window of WINDOW_CHUNKS x WINDOW_CHUNKS
+     * chunks of the streamer, the hero starts in the middle one. When the
+     * hero leaves it, the window moves by whole chunks at the start of the
+     * next step: the level is built again, everything in it moves back by the
+     * same distance, the enemies left outside are gone and new ones come up
+     * to enemy_count. Nobody wins an endless run. The streamer has to outlive
+     * the world.*/
+    world(const chunk_streamer& endless,
+          uint64_t seed,
+          int enemy_count = 5,
+          int threads = 0);
+
+    /*one step of dt seconds. The hero's keys and cursor are read as they
+     * are, set them before the step.*/
+    void step(float dt);
+
+    /*for rendering between two steps: put the entities at blend of the way
+     * from their positions before the last step (0) to the current ones (1).
+     * restore() puts them back, call it before the next step.*/
+    void interpolate(float blend);
+    void restore();
+
+    level lvl;
+    collision_grid static_grid;
+    visibility_table visibility;
+    player* hero;
+
+    int hud_health = 5;    // what the health bar shows
+    bool win = false;
+    bool loose = false;
+
+    frame_stats stats;    // time of the subsystems in every step
+    ai_scheduler ai;      // which enemies think in a step
+
+    chunk_coord origin;    // top left chunk of the endless level
+
+   private:
+    world(const Map& map,
+          uint64_t seed,
+          int enemy_count,
+          int threads,
+          const chunk_streamer* endless);
+
+    /*place up to count enemies on the map of the level, away from the hero
+     * standing on hero_cell*/
+    void spawn_enemies(const Map& map,
+                       int count,
+                       int hero_cell,
+                       const spawn_rules& rules);
+
+    /*move the endless level by (dx, dy) chunks*/
+    void move_window(int dx, int dy);
+
+    /*destroy the entities killed during the previous step*/
+    void remove_dead();
+
+    const chunk_streamer* endless;    // nullptr for a bounded map
+    int enemy_count;
+    pcg32 spawn_rng;
+    uint32_t next_phase = 0;    // ai_control::phase of the next enemy
+
+    std::vector<CHL::instance*> near_walls;
+    spatial_hash entity_hash;
+    std::vector<bullet_hit> hits;
+    std::vector<slot_handle> killed;
+
+    job_system jobs;
+    std::vector<enemy*> thinking;    // the enemies of the current step
+
+    /*entity positions before and after the last step, in entities order*/
+    std::vector<CHL::point> prev_positions;
+    std::vector<CHL::point> positions;
+};
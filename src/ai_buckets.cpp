@@ -0,0 +1,48 @@
+#include "include/ai_buckets.h"
+
+void ai_buckets::add(enemy* e) {
+    ai_bucket& b = bucket(e->state);
+    e->bucket_slot = b.add(e, ai_control{0, true, e->state},
+                           ai_target{CHL::point(), CHL::point()},
+                           ai_motion{0.0f, false, false},
+                           ai_timers{0.0f, 0.0f},
+                           ai_shot{false, CHL::point(), 0.0f});
+}
+
+void ai_buckets::remove(enemy* e) {
+    /*the last one takes the free row, the order inside does not matter*/
+    ai_bucket& b = bucket(e->state);
+    b.remove(e->bucket_slot);
+    if (e->bucket_slot < b.size())
+        b.column<enemy*>()[e->bucket_slot]->bucket_slot = e->bucket_slot;
+}
+
+void ai_buckets::apply_transition(enemy* e) {
+    ai_row from = row_of(e);
+    ai_state next = from.control.next;
+    if (next == e->state)
+        return;
+
+    ai_bucket& b = bucket(next);
+    size_t to = b.add(e, from.control, from.target, from.motion, from.timers,
+                      from.shot);
+    remove(e);
+    e->state = next;
+    e->bucket_slot = to;
+}
+
+void ai_buckets::apply_transitions(const std::vector<enemy*>& enemies) {
+    for (enemy* e : enemies)
+        apply_transition(e);
+}
+
+ai_row ai_buckets::row(ai_state s, size_t i) {
+    ai_bucket& b = bucket(s);
+    return ai_row{b.column<enemy*>()[i], b.column<ai_control>()[i],
+                  b.column<ai_target>()[i], b.column<ai_motion>()[i],
+                  b.column<ai_timers>()[i], b.column<ai_shot>()[i]};
+}
+
+ai_row ai_buckets::row_of(const enemy* e) {
+    return row(e->state, e->bucket_slot);
+}
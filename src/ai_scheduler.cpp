@@ -0,0 +1,30 @@
+#include "include/ai_scheduler.h"
+
+#include <cmath>
+
+#include "include/enemy.h"
+
+void ai_scheduler::schedule(ai_buckets& states, const CHL::point& hero) {
+    const float far2 = rules.far_distance * rules.far_distance;
+    for (int s = 0; s < static_cast<int>(ai_state::count); s++) {
+        states.bucket(static_cast<ai_state>(s))
+            .each<enemy*, ai_control>([&](enemy* e, ai_control& c) {
+                c.thinks = true;
+                float dx = e->position.x - hero.x;
+                float dy = e->position.y - hero.y;
+                if (enabled && (std::fabs(dx) > rules.view_half_width ||
+                                std::fabs(dy) > rules.view_half_height)) {
+                    uint32_t period = dx * dx + dy * dy > far2
+                                          ? rules.far_period
+                                          : rules.near_period;
+                    c.thinks = (step + c.phase) % period == 0;
+                }
+
+                if (c.thinks)
+                    thinks_total++;
+                else
+                    coasts_total++;
+            });
+    }
+    step++;
+}
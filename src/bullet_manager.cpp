@@ -0,0 +1,229 @@
+#include "include/bullet_manager.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if !defined(CHL_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || \
+                              (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define CHL_BULLETS_SSE
+#include <xmmintrin.h>
+#endif
+
+#include "include/global_data.h"
+
+bullet_manager::bullet_manager(size_t capacity)
+    : cap(capacity),
+      x(capacity),
+      y(capacity),
+      prev_x(capacity),
+      prev_y(capacity),
+      vx(capacity),
+      vy(capacity),
+      alpha(capacity),
+      life(capacity),
+      creator(capacity),
+      segments(capacity),
+      wall_hits(capacity) {}
+
+bool bullet_manager::spawn(float _x,
+                           float _y,
+                           float _alpha,
+                           float speed,
+                           bullet_creator _creator,
+                           float lifetime) {
+    if (count == cap)
+        return false;
+
+    x[count] = prev_x[count] = _x;
+    y[count] = prev_y[count] = _y;
+    /*the world y axis looks down*/
+    vx[count] = speed * std::cos(_alpha);
+    vy[count] = -speed * std::sin(_alpha);
+    alpha[count] = _alpha;
+    life[count] = lifetime;
+    creator[count] = _creator;
+    count++;
+    return true;
+}
+
+void bullet_manager::copy(size_t to, size_t from) {
+    x[to] = x[from];
+    y[to] = y[from];
+    prev_x[to] = prev_x[from];
+    prev_y[to] = prev_y[from];
+    vx[to] = vx[from];
+    vy[to] = vy[from];
+    alpha[to] = alpha[from];
+    life[to] = life[from];
+    creator[to] = creator[from];
+}
+
+void bullet_manager::translate(float dx, float dy) {
+    for (size_t i = 0; i < count; i++) {
+        x[i] += dx;
+        y[i] += dy;
+        prev_x[i] += dx;
+        prev_y[i] += dy;
+    }
+}
+
+void bullet_manager::move(float dt) {
+    const float min_x = -TILE_SIZE, max_x = world_width + TILE_SIZE;
+    const float min_y = -TILE_SIZE, max_y = world_height + TILE_SIZE;
+
+    /*survivors are written back from the start of the arrays, in order.
+     * out never passes i, so a bullet is read before its slot is reused.*/
+    size_t out = 0;
+    size_t i = 0;
+
+#ifdef CHL_BULLETS_SSE
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 low_x = _mm_set1_ps(min_x), high_x = _mm_set1_ps(max_x);
+    const __m128 low_y = _mm_set1_ps(min_y), high_y = _mm_set1_ps(max_y);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 old_x = _mm_loadu_ps(&x[i]);
+        __m128 old_y = _mm_loadu_ps(&y[i]);
+        __m128 new_x =
+            _mm_add_ps(old_x, _mm_mul_ps(_mm_loadu_ps(&vx[i]), step));
+        __m128 new_y =
+            _mm_add_ps(old_y, _mm_mul_ps(_mm_loadu_ps(&vy[i]), step));
+        __m128 new_life = _mm_sub_ps(_mm_loadu_ps(&life[i]), step);
+
+        __m128 keep = _mm_and_ps(
+            _mm_and_ps(_mm_cmpgt_ps(new_life, zero),
+                       _mm_and_ps(_mm_cmpge_ps(new_x, low_x),
+                                  _mm_cmple_ps(new_x, high_x))),
+            _mm_and_ps(_mm_cmpge_ps(new_y, low_y),
+                       _mm_cmple_ps(new_y, high_y)));
+        int mask = _mm_movemask_ps(keep);
+
+        /*nothing died so far, the arrays are updated in place*/
+        if (mask == 0xF && out == i) {
+            _mm_storeu_ps(&prev_x[i], old_x);
+            _mm_storeu_ps(&prev_y[i], old_y);
+            _mm_storeu_ps(&x[i], new_x);
+            _mm_storeu_ps(&y[i], new_y);
+            _mm_storeu_ps(&life[i], new_life);
+            out += 4;
+            continue;
+        }
+
+        float lane_old_x[4], lane_old_y[4], lane_x[4], lane_y[4], lane_life[4];
+        _mm_storeu_ps(lane_old_x, old_x);
+        _mm_storeu_ps(lane_old_y, old_y);
+        _mm_storeu_ps(lane_x, new_x);
+        _mm_storeu_ps(lane_y, new_y);
+        _mm_storeu_ps(lane_life, new_life);
+
+        for (int k = 0; k < 4; k++) {
+            if (!(mask & (1 << k)))
+                continue;
+            copy(out, i + k);
+            prev_x[out] = lane_old_x[k];
+            prev_y[out] = lane_old_y[k];
+            x[out] = lane_x[k];
+            y[out] = lane_y[k];
+            life[out] = lane_life[k];
+            out++;
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        float new_x = x[i] + vx[i] * dt;
+        float new_y = y[i] + vy[i] * dt;
+        float new_life = life[i] - dt;
+        if (!(new_life > 0.0f && new_x >= min_x && new_x <= max_x &&
+              new_y >= min_y && new_y <= max_y))
+            continue;
+
+        float old_x = x[i], old_y = y[i];
+        copy(out, i);
+        prev_x[out] = old_x;
+        prev_y[out] = old_y;
+        x[out] = new_x;
+        y[out] = new_y;
+        life[out] = new_life;
+        out++;
+    }
+
+    count = out;
+}
+
+void bullet_manager::collide(const collision_grid& walls,
+                             const spatial_hash& hash,
+                             const std::vector<CHL::life_form*>& targets,
+                             bullet_filter can_hit,
+                             std::vector<bullet_hit>& hits) {
+    hits.clear();
+
+    for (size_t i = 0; i < count; i++) {
+        segments[i].from = CHL::point(prev_x[i], prev_y[i]);
+        segments[i].to = CHL::point(x[i], y[i]);
+    }
+    walls.sweep(segments.data(), count, wall_hits.data());
+
+    /*bullets that hit nothing are kept in order, like in move()*/
+    size_t out = 0;
+    for (size_t i = 0; i < count; i++) {
+        collision_hit best = wall_hits[i];
+        int best_id = -1;
+
+        hash.query(std::min(prev_x[i], x[i]), std::min(prev_y[i], y[i]),
+                   std::max(prev_x[i], x[i]), std::max(prev_y[i], y[i]),
+                   candidates);
+        for (int id : candidates) {
+            CHL::life_form* target = targets[id];
+            if (target == nullptr || !can_hit(creator[i], target))
+                continue;
+            collision_hit h =
+                segment_hit(segments[i].from, segments[i].to, target);
+            if (h.hit && (!best.hit || h.t < best.t)) {
+                best = h;
+                best_id = id;
+            }
+        }
+
+        if (!best.hit) {
+            copy(out++, i);
+            continue;
+        }
+
+        bullet_hit h;
+        h.target = best_id < 0 ? nullptr : targets[best_id];
+        h.target_id = best_id;
+        h.point = best.point;
+        h.creator = creator[i];
+        hits.push_back(h);
+    }
+    count = out;
+}
+
+void bullet_manager::render(CHL::engine* eng,
+                            CHL::camera* cam,
+                            float blend) {
+    if (proxy == nullptr)
+        proxy.reset(new bullet(0.0f, 0.0f, 0.0f, 4, 2));
+
+    /*the same culling as the engine does, but before the quad is built*/
+    CHL::point corner = cam->get_center();
+    float size_x = proxy->size.x, size_y = proxy->size.y;
+
+    for (size_t i = 0; i < count; i++) {
+        float bx = prev_x[i] + (x[i] - prev_x[i]) * blend;
+        float by = prev_y[i] + (y[i] - prev_y[i]) * blend;
+        if (bx + 2 * size_x < corner.x ||
+            bx - size_x > corner.x + cam->width || by + size_y < corner.y ||
+            by - 2 * size_y > corner.y + cam->height)
+            continue;
+
+        proxy->position.x = bx;
+        proxy->position.y = by;
+        proxy->position.z_index = by;
+        proxy->alpha = alpha[i];
+        proxy->update_data();
+        eng->add_object(proxy.get(), cam);
+    }
+}
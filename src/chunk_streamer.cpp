@@ -0,0 +1,250 @@
+#include "include/chunk_streamer.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "dungeon.cpp"
+
+#include "include/global_data.h"
+
+enum class chunk_edge { east, south };
+
+/*splitmix64 finalizer over the seed, the chunk and the purpose of the value*/
+static uint64_t mix(int seed, int x, int y, int purpose) {
+    uint64_t z = static_cast<uint32_t>(seed);
+    z = z * 0x9E3779B97F4A7C15ULL + static_cast<uint32_t>(x);
+    z = z * 0x9E3779B97F4A7C15ULL + static_cast<uint32_t>(y);
+    z = z * 0x9E3779B97F4A7C15ULL + static_cast<uint32_t>(purpose);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*position of the gate on the east or south edge of the chunk (x, y). The
+ * neighbour on the other side of the edge gets the same value.*/
+static int gate_offset(int seed, int x, int y, chunk_edge edge) {
+    return 2 + mix(seed, x, y, 1 + static_cast<int>(edge)) % (CHUNK_SIZE - 4);
+}
+
+static bool is_walkable(Tile t) {
+    return t != Tile::Unused && t != Tile::DirtWall;
+}
+
+/*connect the edge tile (x, y) to the dungeon of the chunk by the shortest
+ * corridor through unused tiles. It ends next to a walkable tile, or at a wall
+ * with a walkable tile right behind it, and that one wall becomes a door.
+ * Nothing else is carved, so a wall along the way is never turned into a
+ * strip of doors.*/
+static void carve_gate(Map& map, int x, int y) {
+    const int size = CHUNK_SIZE;
+    if (is_walkable(map.GetCell(x, y)))
+        return;
+
+    std::vector<int> from(size * size, -1);
+    std::vector<int> queue;
+    queue.reserve(size * size);
+
+    int start = y * size + x;
+    from[start] = start;
+    queue.push_back(start);
+    const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    int end = -1, door = -1;
+    for (size_t head = 0; head < queue.size() && end < 0; head++) {
+        int u = queue[head];
+        int ux = u % size, uy = u / size;
+        if (map.GetCell(ux, uy) != Tile::Unused)
+            continue;
+        for (auto& d : dirs) {
+            int vx = ux + d[0], vy = uy + d[1];
+            if (!map.IsXInBounds(vx) || !map.IsYInBounds(vy))
+                continue;
+            int v = vy * size + vx;
+            Tile t = map.GetCell(vx, vy);
+            if (is_walkable(t)) {
+                end = u;
+                break;
+            }
+            int wx = vx + d[0], wy = vy + d[1];
+            if (t == Tile::DirtWall && map.IsXInBounds(wx) &&
+                map.IsYInBounds(wy) && is_walkable(map.GetCell(wx, wy)) &&
+                !map.IsAdjacent(vx, vy, Tile::Door)) {
+                end = u;
+                door = v;
+                break;
+            }
+            if (t == Tile::Unused && from[v] < 0) {
+                from[v] = u;
+                queue.push_back(v);
+            }
+        }
+    }
+    if (end < 0)
+        return;
+
+    if (door >= 0)
+        map.SetCell(door % size, door / size, Tile::Door);
+    for (int u = end;; u = from[u]) {
+        map.SetCell(u % size, u / size, Tile::Corridor);
+        if (u == start)
+            break;
+    }
+}
+
+/*division rounding to the negative infinity*/
+static int floor_div(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+chunk_streamer::chunk_streamer(int _seed, int _radius)
+    : seed(_seed), radius(_radius) {
+    worker = std::thread(&chunk_streamer::work, this);
+}
+
+chunk_streamer::~chunk_streamer() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+Map chunk_streamer::generate_chunk(int seed, const chunk_coord& c) {
+    /*the dungeon is one tile in from the edges, so every gate starts on an
+     * unused tile. Chunks are made on the worker, nobody reads its output.*/
+    DungeonGenerator generator(CHUNK_SIZE - 2, CHUNK_SIZE - 2);
+    generator.Verbose = false;
+    Map inner = generator.Generate(mix(seed, c.x, c.y, 0) % 1000000000);
+    Map map(CHUNK_SIZE, CHUNK_SIZE, Tile::Unused);
+    for (int y = 0; y < CHUNK_SIZE - 2; y++)
+        for (int x = 0; x < CHUNK_SIZE - 2; x++)
+            map.SetCell(x + 1, y + 1, inner.GetCell(x, y));
+
+    const int last = CHUNK_SIZE - 1;
+    carve_gate(map, 0, gate_offset(seed, c.x - 1, c.y, chunk_edge::east));
+    carve_gate(map, last, gate_offset(seed, c.x, c.y, chunk_edge::east));
+    carve_gate(map, gate_offset(seed, c.x, c.y - 1, chunk_edge::south), 0);
+    carve_gate(map, gate_offset(seed, c.x, c.y, chunk_edge::south), last);
+
+    return map;
+}
+
+chunk_coord chunk_streamer::chunk_of(int tile_x, int tile_y) {
+    return chunk_coord(floor_div(tile_x, CHUNK_SIZE),
+                       floor_div(tile_y, CHUNK_SIZE));
+}
+
+bool chunk_streamer::in_range(const chunk_coord& c, int r) const {
+    return std::abs(c.x - center.x) <= r && std::abs(c.y - center.y) <= r;
+}
+
+void chunk_streamer::update(CHL::camera* cam, const chunk_coord& origin) {
+    CHL::point corner = cam->get_center();    // top left corner
+    update(origin.x * CHUNK_SIZE +
+               static_cast<int>(corner.x + cam->width / 2) / TILE_SIZE,
+           origin.y * CHUNK_SIZE +
+               static_cast<int>(corner.y + cam->height / 2) / TILE_SIZE);
+}
+
+void chunk_streamer::update(int tile_x, int tile_y) {
+    chunk_coord c = chunk_of(tile_x, tile_y);
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (c == center && !chunks.empty())
+        return;
+    center = c;
+
+    /*one chunk of hysteresis, so walking along the border does not make the
+     * same chunks generated and evicted again and again*/
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        if (!in_range(it->first, radius + 1))
+            it = chunks.erase(it);
+        else
+            ++it;
+    }
+
+    /*nearest chunks go first*/
+    for (int r = 0; r <= radius; r++) {
+        for (int y = c.y - r; y <= c.y + r; y++) {
+            for (int x = c.x - r; x <= c.x + r; x++) {
+                if (std::abs(x - c.x) != r && std::abs(y - c.y) != r)
+                    continue;
+                chunk_coord n(x, y);
+                if (chunks.count(n) || pending.count(n))
+                    continue;
+                pending.insert(n);
+                requests.push_back(n);
+            }
+        }
+    }
+    wake.notify_one();
+}
+
+std::shared_ptr<const chunk> chunk_streamer::get_chunk(
+    const chunk_coord& c) const {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = chunks.find(c);
+    return it == chunks.end() ? nullptr : it->second;
+}
+
+Tile chunk_streamer::get_cell(int x, int y) const {
+    chunk_coord c = chunk_of(x, y);
+    std::shared_ptr<const chunk> ch = get_chunk(c);
+    if (ch == nullptr)
+        return Tile::Unused;
+    return ch->map.GetCell(x - c.x * CHUNK_SIZE, y - c.y * CHUNK_SIZE);
+}
+
+size_t chunk_streamer::resident() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return chunks.size();
+}
+
+Map chunk_streamer::stitch(const chunk_coord& first, int count) const {
+    Map map(count * CHUNK_SIZE, count * CHUNK_SIZE, Tile::Unused);
+    for (int cy = 0; cy < count; cy++) {
+        for (int cx = 0; cx < count; cx++) {
+            chunk_coord c(first.x + cx, first.y + cy);
+            std::shared_ptr<const chunk> ch = get_chunk(c);
+            Map generated;
+            if (ch == nullptr)
+                generated = generate_chunk(seed, c);
+            const Map& part = ch != nullptr ? ch->map : generated;
+
+            for (int y = 0; y < CHUNK_SIZE; y++)
+                for (int x = 0; x < CHUNK_SIZE; x++)
+                    map.SetCell(cx * CHUNK_SIZE + x, cy * CHUNK_SIZE + y,
+                                part.GetCell(x, y));
+        }
+    }
+    return map;
+}
+
+void chunk_streamer::work() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this] { return stop || !requests.empty(); });
+        if (stop)
+            return;
+
+        chunk_coord c = requests.front();
+        requests.pop_front();
+
+        /*the camera could go away while the request was waiting*/
+        if (!in_range(c, radius + 1)) {
+            pending.erase(c);
+            continue;
+        }
+
+        guard.unlock();
+        std::shared_ptr<chunk> ch = std::make_shared<chunk>();
+        ch->coord = c;
+        ch->map = generate_chunk(seed, c);
+        guard.lock();
+
+        pending.erase(c);
+        if (in_range(c, radius + 1))
+            chunks[c] = ch;
+    }
+}
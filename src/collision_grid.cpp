@@ -0,0 +1,155 @@
+#include "include/collision_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "include/global_data.h"
+
+collision_grid::collision_grid(const level& lvl)
+    : width(lvl.width),
+      height(lvl.height),
+      cells(lvl.cells),
+      wall_boxes(lvl.wall_boxes),
+      wall_box_of(lvl.wall_box_of) {}
+
+void collision_grid::tile_range(float left,
+                                float top,
+                                float right,
+                                float bottom,
+                                int& x0,
+                                int& y0,
+                                int& x1,
+                                int& y1) const {
+    x0 = std::max(0, static_cast<int>(std::floor(left / TILE_SIZE)));
+    x1 = std::min(width - 1, static_cast<int>(std::floor(right / TILE_SIZE)));
+    y0 = std::max(0, static_cast<int>(std::floor(top / TILE_SIZE)));
+    y1 = std::min(height - 1, static_cast<int>(std::floor(bottom / TILE_SIZE)));
+}
+
+void collision_grid::query_walls(CHL::instance* inst,
+                                 std::vector<CHL::instance*>& out) const {
+    out.clear();
+
+    float left = inst->position.x + inst->collision_box_offset.x;
+    float bottom = inst->position.y - inst->collision_box_offset.y;
+    int x0, y0, x1, y1;
+    tile_range(left, bottom - inst->collision_box.y,
+               left + inst->collision_box.x, bottom, x0, y0, x1, y1);
+
+    /*an entity overlaps a few tiles only, a linear search for duplicates is
+     * cheaper than any set*/
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            int id = wall_box_of[y * width + x];
+            if (id < 0)
+                continue;
+            CHL::instance* box = wall_boxes[id];
+            if (std::find(out.begin(), out.end(), box) == out.end())
+                out.push_back(box);
+        }
+    }
+}
+
+collision_hit segment_hit(const CHL::point& from,
+                          const CHL::point& to,
+                          CHL::instance* box) {
+    collision_hit result;
+
+    float left = box->position.x + box->collision_box_offset.x;
+    float right = left + box->collision_box.x;
+    float bottom = box->position.y - box->collision_box_offset.y;
+    float top = bottom - box->collision_box.y;
+
+    float t_enter = 0.0f, t_exit = 1.0f;
+    int enter_axis = -1;
+    const float from_axis[2] = {from.x, from.y};
+    const float d_axis[2] = {to.x - from.x, to.y - from.y};
+    const float low[2] = {left, top};
+    const float high[2] = {right, bottom};
+
+    for (int i = 0; i < 2; i++) {
+        if (d_axis[i] == 0.0f) {
+            if (from_axis[i] < low[i] || from_axis[i] > high[i])
+                return result;
+            continue;
+        }
+        float t0 = (low[i] - from_axis[i]) / d_axis[i];
+        float t1 = (high[i] - from_axis[i]) / d_axis[i];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        if (t0 > t_enter) {
+            t_enter = t0;
+            enter_axis = i;
+        }
+        t_exit = std::min(t_exit, t1);
+        if (t_enter > t_exit)
+            return result;
+    }
+
+    result.hit = true;
+    result.t = t_enter;
+    result.point = CHL::point(from.x + t_enter * d_axis[0],
+                              from.y + t_enter * d_axis[1]);
+    /*the entered face looks against the movement*/
+    if (enter_axis == 0)
+        result.normal.x = d_axis[0] > 0 ? -1.0f : 1.0f;
+    else if (enter_axis == 1)
+        result.normal.y = d_axis[1] > 0 ? -1.0f : 1.0f;
+    result.object = box;
+    return result;
+}
+
+collision_hit collision_grid::sweep(const CHL::point& from,
+                                    const CHL::point& to) const {
+    const float inf = std::numeric_limits<float>::infinity();
+    const float dx = to.x - from.x, dy = to.y - from.y;
+
+    int x = static_cast<int>(std::floor(from.x / TILE_SIZE));
+    int y = static_cast<int>(std::floor(from.y / TILE_SIZE));
+    const int end_x = static_cast<int>(std::floor(to.x / TILE_SIZE));
+    const int end_y = static_cast<int>(std::floor(to.y / TILE_SIZE));
+
+    const int step_x = dx > 0 ? 1 : -1, step_y = dy > 0 ? 1 : -1;
+
+    /*segment parameter of the next vertical and horizontal tile border*/
+    float t_max_x =
+        dx != 0 ? ((x + (step_x > 0)) * TILE_SIZE - from.x) / dx : inf;
+    float t_max_y =
+        dy != 0 ? ((y + (step_y > 0)) * TILE_SIZE - from.y) / dy : inf;
+    const float t_delta_x = dx != 0 ? TILE_SIZE / std::fabs(dx) : inf;
+    const float t_delta_y = dy != 0 ? TILE_SIZE / std::fabs(dy) : inf;
+
+    while (true) {
+        if (x >= 0 && x < width && y >= 0 && y < height) {
+            CHL::instance* brick = cells[y * width + x];
+            if (brick != nullptr) {
+                collision_hit h = segment_hit(from, to, brick);
+                if (h.hit)
+                    return h;
+            }
+        }
+
+        if (x == end_x && y == end_y)
+            return collision_hit();
+
+        if (t_max_x < t_max_y) {
+            if (t_max_x > 1.0f)
+                return collision_hit();
+            x += step_x;
+            t_max_x += t_delta_x;
+        } else {
+            if (t_max_y > 1.0f)
+                return collision_hit();
+            y += step_y;
+            t_max_y += t_delta_y;
+        }
+    }
+}
+
+void collision_grid::sweep(const segment_query* queries,
+                           size_t count,
+                           collision_hit* out) const {
+    for (size_t i = 0; i < count; i++)
+        out[i] = sweep(queries[i].from, queries[i].to);
+}
@@ -52,9 +52,9 @@ void render_screen(CHL::engine* eng,
 
         float t = (eng->GL_time() - prev_frame) * 1000;
 
-        if (t < 1000 / FPS)
+        if (t < 1000.0f / FPS)
             std::this_thread::sleep_for(
-                std::chrono::milliseconds(1000 / FPS - (int)t));
+                std::chrono::duration<float, std::milli>(1000.0f / FPS - t));
     }
     if (snd != nullptr)
         snd->stop();
@@ -1,167 +1,11 @@
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <random>
 #include <cassert>
 #include <time.h>
 
-enum class Tile {
-    Unused,
-    DirtWall,
-    DirtFloor,
-    Corridor,
-    Door,
-    UpStairs,
-    DownStairs
-};
-
-enum class Direction {
-    North,
-    South,
-    East,
-    West,
-};
-
-class Map {
-   public:
-    Map() : xSize(0), ySize(0), data() {}
-
-    Map(int x, int y, Tile value = Tile::Unused)
-        : xSize(x), ySize(y), data(x * y, value) {}
-
-    void SetCell(int x, int y, Tile celltype) {
-        assert(IsXInBounds(x));
-        assert(IsYInBounds(y));
-
-        data[x + xSize * y] = celltype;
-    }
-
-    Tile GetCell(int x, int y) const {
-        assert(IsXInBounds(x));
-        assert(IsYInBounds(y));
-
-        return data[x + xSize * y];
-    }
-
-    void SetCells(int xStart, int yStart, int xEnd, int yEnd, Tile cellType) {
-        assert(IsXInBounds(xStart) && IsXInBounds(xEnd));
-        assert(IsYInBounds(yStart) && IsYInBounds(yEnd));
-
-        assert(xStart <= xEnd);
-        assert(yStart <= yEnd);
-
-        for (auto y = yStart; y != yEnd + 1; ++y)
-            for (auto x = xStart; x != xEnd + 1; ++x)
-                SetCell(x, y, cellType);
-    }
-
-    bool IsXInBounds(int x) const { return x >= 0 && x < xSize; }
-
-    bool IsYInBounds(int y) const { return y >= 0 && y < ySize; }
-
-    bool IsAreaUnused(int xStart, int yStart, int xEnd, int yEnd) {
-        assert(IsXInBounds(xStart) && IsXInBounds(xEnd));
-        assert(IsYInBounds(yStart) && IsYInBounds(yEnd));
-
-        assert(xStart <= xEnd);
-        assert(yStart <= yEnd);
-
-        for (auto y = yStart; y != yEnd + 1; ++y)
-            for (auto x = xStart; x != xEnd + 1; ++x)
-                if (GetCell(x, y) != Tile::Unused)
-                    return false;
-
-        return true;
-    }
-
-    bool IsAdjacent(int x, int y, Tile tile) {
-        assert(IsXInBounds(x - 1) && IsXInBounds(x + 1));
-        assert(IsYInBounds(y - 1) && IsYInBounds(y + 1));
-
-        return GetCell(x - 1, y) == tile || GetCell(x + 1, y) == tile ||
-               GetCell(x, y - 1) == tile || GetCell(x, y + 1) == tile;
-    }
-
-    std::vector<int> Print() {
-        // TODO: proper ostream iterator.
-        // TODO: proper lookup of character from enum.
-
-        std::vector<int> tile_set;
-
-        for (auto y = 0; y != ySize; y++) {
-            for (auto x = 0; x != xSize; x++) {
-                switch (GetCell(x, y)) {
-                        //                    case Tile::Unused:
-                        //                        tile_set.insert(tile_set.end(),
-                        //                        ' '); break;
-                        //                    case Tile::DirtWall:
-                        //                        tile_set.insert(tile_set.end(),
-                        //                        '#'); break;
-                        //                    case Tile::DirtFloor:
-                        //                        tile_set.insert(tile_set.end(),
-                        //                        '.'); break;
-                        //                    case Tile::Corridor:
-                        //                        tile_set.insert(tile_set.end(),
-                        //                        '.'); break;
-                        //                    case Tile::Door:
-                        //                        tile_set.insert(tile_set.end(),
-                        //                        '+'); break;
-                        //                    case Tile::UpStairs:
-                        //                        tile_set.insert(tile_set.end(),
-                        //                        '<'); break;
-                        //                    case Tile::DownStairs:
-                        //                        tile_set.insert(tile_set.end(),
-                        //                        '>'); break;
-                    case Tile::DirtWall:
-                    case Tile::Unused:
-                        tile_set.insert(tile_set.end(), 1);
-                        break;
-                    default:
-                        tile_set.insert(tile_set.end(), 0);
-                };
-                switch (GetCell(x, y)) {
-                    case Tile::Unused:
-                        std::cout << " ";
-                        break;
-                    case Tile::DirtWall:
-                        std::cout << "#";
-                        break;
-                    case Tile::DirtFloor:
-                        std::cout << ".";
-                        break;
-                    case Tile::Corridor:
-                        std::cout << ".";
-                        break;
-                    case Tile::Door:
-                        std::cout << "+";
-                        break;
-                    case Tile::UpStairs:
-                        std::cout << "<";
-                        break;
-                    case Tile::DownStairs:
-                        std::cout << ">";
-                        break;
-                };
-            }
-            std::cout << std::endl;
-        }
-        //        for (auto y = 0; y != ySize; y++) {
-        //            for (auto x = 0; x != xSize; x++) {
-        //                std::cout << *(tile_set.begin() + y * ySize + x) << "
-        //                ";
-        //            }
-        //            std::cout << std::endl;
-        //        }
-
-        std::cout << std::endl;
-
-        return tile_set;
-    }
-
-   private:
-    int xSize, ySize;
-
-    std::vector<Tile> data;
-};
+#include "include/map.h"
 
 class DungeonGenerator {
    public:
@@ -173,25 +17,34 @@ class DungeonGenerator {
 
     int ChanceRoom, ChanceCorridor;
 
+    bool Verbose;    // print what could not be placed
+
     DungeonGenerator(int x, int y)
         : Seed(std::random_device()()),
           XSize(x),
           YSize(y),
-          MaxFeatures(100),
+          MaxFeatures(std::max(100, x * y / 32)),
           ChanceRoom(75),
-          ChanceCorridor(25) {}
+          ChanceCorridor(25),
+          Verbose(true) {}
 
     Map Generate() {
-        // TODO: proper input validation.
-        assert(MaxFeatures > 0 && MaxFeatures <= 100);
-        assert(XSize > 3 && XSize <= 80);
-        assert(YSize > 3 && YSize <= 50);
         std::srand(time(nullptr));
         Seed = rand() % 1000000000;
 
-        auto rng = RngT(Seed);
         std::cout << Seed << std::endl;
 
+        return Generate(Seed);
+    }
+
+    /*the same seed always gives the same map*/
+    Map Generate(int seed) const {
+        // TODO: proper input validation.
+        assert(MaxFeatures > 0);
+        assert(XSize > 3 && YSize > 3);
+
+        auto rng = RngT(seed);
+
         auto map = Map(XSize, YSize, Tile::Unused);
 
         MakeDungeon(map, rng);
@@ -340,7 +193,9 @@ class DungeonGenerator {
 
     bool MakeFeature(Map& map, RngT& rng) const {
         auto tries = 0;
-        auto maxTries = 1000;
+        // The chance to hit a wall or corridor tile falls with the map area,
+        // so big maps get more tries. Up to 64x64 it stays at 1000.
+        auto maxTries = std::max(1000, XSize * YSize / 4);
 
         for (; tries != maxTries; ++tries) {
             // Pick a random wall or corridor tile.
@@ -410,24 +265,20 @@ class DungeonGenerator {
 
         for (auto features = 1; features != MaxFeatures; ++features) {
             if (!MakeFeature(map, rng)) {
-                std::cout << "Unable to place more features (placed "
-                          << features << ")." << std::endl;
+                if (Verbose)
+                    std::cout << "Unable to place more features (placed "
+                              << features << ")." << std::endl;
                 break;
             }
         }
 
-        if (!MakeStairs(map, rng, Tile::UpStairs))
+        if (!MakeStairs(map, rng, Tile::UpStairs) && Verbose)
             std::cout << "Unable to place up stairs." << std::endl;
 
-        if (!MakeStairs(map, rng, Tile::DownStairs))
+        if (!MakeStairs(map, rng, Tile::DownStairs) && Verbose)
             std::cout << "Unable to place down stairs." << std::endl;
 
         return true;
     }
 };
 
-//	DungeonGenerator generator;
-//
-//	auto map = generator.Generate();
-//
-//	map.Print();
@@ -0,0 +1,102 @@
+#include "include/effects.h"
+
+#include "include/global_data.h"
+
+static constexpr int EXPLOSION_SIZE = TILE_SIZE / 2 + 2;
+static constexpr int EXPLOSION_FRAMES = 8;
+static constexpr int EXPLOSION_FPS = 8;
+
+void effect_world::spawn_explosion(float x, float y) {
+    transform t{x - TILE_SIZE / 4 - 1, y + TILE_SIZE / 4 + 1, MIN_DEPTH};
+    sprite s{EXPLOSION_SIZE, 0, EXPLOSION_FRAMES, 0, 1};
+    frame_timer timer{1.0f / EXPLOSION_FPS, 1.0f / EXPLOSION_FPS};
+    explosions.add(t, s, timer);
+}
+
+void effect_world::spawn_fade(const CHL::instance* look) {
+    transform t{look->position.x, look->position.y, look->position.z_index};
+    /*the same texture settings as the original, for realistic effect*/
+    sprite s{TILE_SIZE, look->selected_frame, look->frames_in_texture,
+             look->selected_tileset, look->tilesets_in_texture};
+    fades.add(t, s, fade{1.0f});
+}
+
+void effect_world::animate(float dt) {
+    std::vector<sprite>& sprites = explosions.column<sprite>();
+    std::vector<frame_timer>& timers = explosions.column<frame_timer>();
+
+    for (size_t i = explosions.size(); i-- > 0;) {
+        sprite& s = sprites[i];
+        /*the last frame was shown for one step, it is over*/
+        if (s.frame == s.frames_in_texture - 1) {
+            explosions.remove(i);
+            continue;
+        }
+        timers[i].delay -= dt;
+        if (timers[i].delay <= 0.0f) {
+            timers[i].delay += timers[i].frame_delay;
+            s.frame++;
+        }
+    }
+}
+
+CHL::instance* effect_world::quad(const transform& t, const sprite& s) {
+    if (proxy == nullptr)
+        proxy.reset(new CHL::instance(0.0f, 0.0f, 0.0f, TILE_SIZE));
+
+    proxy->position.x = t.x;
+    proxy->position.y = t.y;
+    proxy->position.z_index = t.z_index;
+    proxy->size = CHL::point(s.size, s.size);
+    proxy->selected_frame = s.frame;
+    proxy->frames_in_texture = s.frames_in_texture;
+    proxy->selected_tileset = s.tileset;
+    proxy->tilesets_in_texture = s.tilesets_in_texture;
+    proxy->update_data();
+    return proxy.get();
+}
+
+void effect_world::render_explosions(CHL::engine* eng,
+                                     CHL::camera* cam,
+                                     CHL::texture* tex) {
+    if (explosions.empty())
+        return;
+
+    explosions.each<transform, sprite>([&](transform& t, sprite& s) {
+        eng->add_object(quad(t, s), cam);
+    });
+    eng->render(tex, cam, nullptr);
+}
+
+void effect_world::render_fades(CHL::engine* eng,
+                                CHL::camera* cam,
+                                CHL::texture* tex,
+                                float dt) {
+    std::vector<transform>& transforms = fades.column<transform>();
+    std::vector<sprite>& sprites = fades.column<sprite>();
+    std::vector<fade>& alphas = fades.column<fade>();
+
+    for (size_t i = fades.size(); i-- > 0;) {
+        CHL::instance* q = quad(transforms[i], sprites[i]);
+        eng->add_object(q, cam);
+        alphas[i].alpha -= dt * 5;
+        q->alpha_channel = alphas[i].alpha;
+        eng->render(tex, cam, q);
+        if (alphas[i].alpha <= 0.05f)
+            fades.remove(i);
+    }
+}
+
+void effect_world::translate(float dx, float dy) {
+    auto shift = [dx, dy](transform& t) {
+        t.x += dx;
+        t.y += dy;
+    };
+    explosions.each<transform>(shift);
+    fades.each<transform>(shift);
+}
+
+void effect_world::clear() {
+    explosions.clear();
+    fades.clear();
+}
@@ -3,29 +3,45 @@
 #include <math.h>
 #include <iostream>
 
+#include "include/ai_buckets.h"
 #include "include/game_functions.hxx"
 #include "include/global_data.h"
 #include "include/pathfinders.h"
 
-std::vector<CHL::instance*> non_material_quads;
-std::vector<CHL::life_form*> entities;
+effect_world effects;
+slot_map<CHL::life_form*> entities;
 std::vector<CHL::instance*> bricks;
-std::vector<bullet*> bullets;
+bullet_manager bullets(MAX_BULLETS);
+line_of_sight sight;
+int live_enemies = 0;
 resource_manager manager;
-static float SHOOT_DELAY = 1.0f;
+rng_service random_streams;
+int world_width = VIRTUAL_WIDTH, world_height = VIRTUAL_HEIGHT;
+game_tuning tuning;
+ai_buckets enemy_states;
 static float DELTA_FIND = 1.0f;
-static uint32_t HEALTH = 3;
 
-void stall(enemy* e, float dt);
-void chase(enemy* e, float dt);
-void smart_move(enemy* e, float dt);
+void stall(const ai_row& r, float dt);
+void chase(const ai_row& r, float dt);
+void smart_move(const ai_row& r, float dt);
+
+/*true if the enemy can see its destination*/
+static bool sees_destination(const ai_row& r) {
+    enemy* e = r.e;
+    return sight.visible(
+        CHL::point(e->position.x + e->collision_box.x / 2,
+                   e->position.y - e->collision_box.y / 2),
+        r.target.destination);
+}
 
 enemy::enemy(float x, float y, float z, int _speed, int s)
     : life_form(x, y, z, _speed, s) {
-    health = HEALTH;
+    health = tuning.enemy_health;
+    kind = static_cast<int>(entity_kind::enemy);
+    live_enemies++;
 
-    /*starting with the pathfind*/
-    state = smart_move;
+    /*starting with the pathfind (the default state)*/
+    enemy_states.add(this);
 
     collision_box.x = TILE_SIZE / 2.0f + 2.0f;
     collision_box.y -= 2.0f;
@@ -33,8 +49,9 @@ enemy::enemy(float x, float y, float z, int _speed, int s)
     fire_source = CHL::create_new_source(manager.get_sound("shot_sound"), this);
     steps_source =
         CHL::create_new_source(manager.get_sound("move_sound"), this);
+    rng = random_streams.next_stream(rng_system::enemies);
     CHL::pitch_s(steps_source,
-                 1 + (rand() % 100 - 50) /
+                 1 + rng.range(-50, 49) /
                          300.0f);    // a bit of randomness in the steps
 
     visor_light =
@@ -54,38 +71,46 @@ enemy::enemy(float x, float y, float z, int _speed, int _size_x, int _size_y)
 
 enemy::~enemy() {
     std::cerr << "Enemy crushed!" << std::endl;
-    if (moving)
+    live_enemies--;
+    if (enemy_states.row_of(this).motion.moving)
         CHL::stop_s(steps_source);
     CHL::delete_source(steps_source);
+    enemy_states.remove(this);
 
     CHL::stop_s(fire_source);
     CHL::delete_source(fire_source);
 
-    state = NULL;
     delete visor_light;
 }
 
-void pathfind(enemy* e) {
-    int o_buff[x_size * y_size];
-    int s = AStarFindPath(
-        e->position.x / TILE_SIZE, (e->position.y - 0.05f) / TILE_SIZE,
-        e->destination.x / TILE_SIZE, (e->destination.y) / TILE_SIZE, e->map,
-        x_size, y_size, o_buff, x_size * y_size);
+void pathfind(const ai_row& r) {
+    /*the map can be too big for the stack, one buffer per thinking thread*/
+    static thread_local std::vector<int> o_buff;
+    enemy* e = r.e;
+    const CHL::point& d = r.target.destination;
+    CHL::point& step = r.target.step;
+    const int w = e->map_width, h = e->map_height;
+    o_buff.resize(w * h);
+    int s = AStarFindPath(e->position.x / TILE_SIZE,
+                          (e->position.y - 0.05f) / TILE_SIZE, d.x / TILE_SIZE,
+                          (d.y) / TILE_SIZE, e->map, w, h, o_buff.data(),
+                          w * h);
 
     /*if path length > 1*/
     if (s >= 1) {
-        e->step_dest.y = (o_buff[0] / x_size) * TILE_SIZE - 2 + TILE_SIZE;
-        e->step_dest.x =
-            (o_buff[0] - x_size * (o_buff[0] / x_size)) * TILE_SIZE;
+        step.y = (o_buff[0] / w) * TILE_SIZE - 2 + TILE_SIZE;
+        step.x = (o_buff[0] - w * (o_buff[0] / w)) * TILE_SIZE;
     } else {
-        e->step_dest.y = e->position.y;
-        e->step_dest.x = e->position.x;
+        step.y = e->position.y;
+        step.x = e->position.x;
     }
 }
 
-float change_sprite(enemy* e) {
-    float a = CHL::get_direction(e->step_dest.x, e->step_dest.y, e->position.x,
-                                 e->position.y);
+float change_sprite(const ai_row& r) {
+    enemy* e = r.e;
+    const bool moving = r.motion.moving;
+    float a = CHL::get_direction(r.target.step.x, r.target.step.y,
+                                 e->position.x, e->position.y);
 
     /*changing selected tileset for animations or frame for stall state
      * depending on current direction. Also a bit of change for the light
@@ -94,7 +119,7 @@ float change_sprite(enemy* e) {
     if (a > (3 * M_PI_2 + M_PI_4) || a <= M_PI_4) {
         e->light_offset.x = 2;
         e->light_offset.y = 0;
-        if (!e->moving) {
+        if (!moving) {
             e->selected_frame = 3;
         } else {
             e->light_offset.x = 4;
@@ -103,7 +128,7 @@ float change_sprite(enemy* e) {
     } else if (a > M_PI_4 && a <= M_PI_2 + M_PI_4) {
         e->light_offset.x = 0;
         e->light_offset.y = 0;
-        if (!e->moving)
+        if (!moving)
             e->selected_frame = 0;
         else {
             e->light_offset.y = -2;
@@ -113,7 +138,7 @@ float change_sprite(enemy* e) {
     } else if (a > M_PI_2 + M_PI_4 && a < M_PI + M_PI_4) {
         e->light_offset.x = -2;
         e->light_offset.y = 0;
-        if (!e->moving)
+        if (!moving)
             e->selected_frame = 2;
         else {
             e->light_offset.x = 0;
@@ -122,7 +147,7 @@ float change_sprite(enemy* e) {
     } else {
         e->light_offset.x = 0;
         e->light_offset.y = 0;
-        if (!e->moving)
+        if (!moving)
             e->selected_frame = 1;
         else {
             e->light_offset.y = -2;
@@ -133,32 +158,33 @@ float change_sprite(enemy* e) {
     return a;
 }
 
-void stall(enemy* e, float dt) {
-    e->step_dest.x = e->destination.x;
-    e->step_dest.y = e->destination.y;
+void stall(const ai_row& r, float dt) {
+    enemy* e = r.e;
+    const CHL::point& d = r.target.destination;
+    r.target.step = d;
 
     /*if player if far or isn't visible for enemy, begin pathfinding*/
-    if (CHL::get_distance(e->destination.x, e->destination.y, e->position.x,
-                          e->position.y) > TILE_SIZE * 5 ||
-        !CHL::ray_cast(e, e->destination, bricks)) {
-        e->step_dest.x = e->position.x;
-        e->step_dest.y = e->position.y;
-        e->state = smart_move;
+    if (CHL::get_distance(d.x, d.y, e->position.x, e->position.y) >
+            TILE_SIZE * 5 ||
+        !sees_destination(r)) {
+        r.target.step.x = e->position.x;
+        r.target.step.y = e->position.y;
+        r.control.next = ai_state::smart_move;
     }
-    float a = change_sprite(e);
-    e->shooting_alpha = a;
-    e->fire();
+    r.motion.alpha = change_sprite(r);
+    enemy::fire(r);
 }
 
-void chase(enemy* e, float dt) {
+void chase(const ai_row& r, float dt) {
+    enemy* e = r.e;
+    const CHL::point& d = r.target.destination;
     /*current step destination become a player's position*/
-    e->step_dest.x = e->destination.x;
-    e->step_dest.y = e->destination.y;
+    r.target.step = d;
 
     float path = e->speed * dt;
-    float a = change_sprite(e);
-    e->shooting_alpha = a;
-    e->fire();
+    float a = change_sprite(r);
+    r.motion.alpha = a;
+    enemy::fire(r);
 
     e->delta_x = path * std::cos(a);
     e->delta_y = -path * std::sin(a);
@@ -167,29 +193,31 @@ void chase(enemy* e, float dt) {
     e->position.x += e->delta_x;
 
     /*if player is not visible, begin pathfind*/
-    if (!CHL::ray_cast(e, e->destination, bricks)) {
-        e->step_dest.x = e->position.x;
-        e->step_dest.y = e->position.y;
-        e->state = smart_move;
+    if (!sees_destination(r)) {
+        r.target.step.x = e->position.x;
+        r.target.step.y = e->position.y;
+        r.control.next = ai_state::smart_move;
     }
     /*if player is close, then stop and fire*/
-    if (CHL::get_distance(e->destination.x, e->destination.y, e->position.x,
-                          e->position.y) < e->size.x * 4) {
-        e->state = stall;
+    if (CHL::get_distance(d.x, d.y, e->position.x, e->position.y) <
+        e->size.x * 4) {
+        r.control.next = ai_state::stall;
     }
 }
 
-void smart_move(enemy* e, float dt) {
+void smart_move(const ai_row& r, float dt) {
+    enemy* e = r.e;
+    const CHL::point& step = r.target.step;
     /*if we are close to the destination point, find a new one via pathfinding*/
-    if ((std::fabs(e->position.x - e->step_dest.x) < 3.0f &&
-         std::fabs(e->position.y - e->step_dest.y) < 3.0f) ||
-        e->delta_find <= 0) {
-        e->delta_find = DELTA_FIND;
-        pathfind(e);
+    if ((std::fabs(e->position.x - step.x) < 3.0f &&
+         std::fabs(e->position.y - step.y) < 3.0f) ||
+        r.timers.find <= 0) {
+        r.timers.find = DELTA_FIND;
+        pathfind(r);
     }
     float path = e->speed * dt;
-    float a = change_sprite(e);
-    e->shooting_alpha = a;
+    float a = change_sprite(r);
+    r.motion.alpha = a;
 
     e->delta_x = path * std::cos(a);
     e->delta_y = -path * std::sin(a);
@@ -198,39 +226,139 @@ void smart_move(enemy* e, float dt) {
     e->position.x += e->delta_x;
 
     /*stop thinking, begin chasing the player*/
-    if (CHL::ray_cast(e, e->destination, bricks)) {
-        e->state = chase;
+    if (sees_destination(r)) {
+        r.control.next = ai_state::chase;
     }
 }
 
-void do_actions(enemy* e, float dt) {
-    if (e->shoot_delay > 0)
-        e->shoot_delay -= dt;
-    if (e->delta_find > 0)
-        e->delta_find -= dt;
+void do_actions(const ai_row& r, float dt) {
+    if (r.timers.shoot > 0)
+        r.timers.shoot -= dt;
+    if (r.timers.find > 0)
+        r.timers.find -= dt;
 }
 
 void enemy::move(float dt) {
-    delta_x = 0;
-    delta_y = 0;
+    think_bucket(state, bucket_slot, bucket_slot + 1, dt);
+    enemy_states.apply_transition(this);
+    apply();
+}
+
+template <void (*S)(const ai_row&, float)>
+void enemy::think_loop(ai_state s, size_t begin, size_t end, float dt) {
+    /*the columns once, the rows stream through them*/
+    ai_bucket& b = enemy_states.bucket(s);
+    std::vector<enemy*>& es = b.column<enemy*>();
+    std::vector<ai_control>& control = b.column<ai_control>();
+    std::vector<ai_target>& target = b.column<ai_target>();
+    std::vector<ai_motion>& motion = b.column<ai_motion>();
+    std::vector<ai_timers>& timers = b.column<ai_timers>();
+    std::vector<ai_shot>& shot = b.column<ai_shot>();
+    for (size_t i = begin; i < end; i++) {
+        const ai_row r{es[i],     control[i], target[i],
+                       motion[i], timers[i],  shot[i]};
+        if (r.control.thinks) {
+            begin_think(r);
+            S(r, dt);
+            end_think(r, dt);
+        } else {
+            coast(r, dt);
+        }
+    }
+}
+
+void enemy::think_bucket(ai_state s, size_t begin, size_t end, float dt) {
+    switch (s) {
+        case ai_state::smart_move:
+            think_loop<smart_move>(s, begin, end, dt);
+            break;
+        case ai_state::chase:
+            think_loop<chase>(s, begin, end, dt);
+            break;
+        default:
+            think_loop<stall>(s, begin, end, dt);
+            break;
+    }
+}
 
-    /*execute current node in the decision tree*/
-    state(this, dt);
+void enemy::begin_think(const ai_row& r) {
+    r.e->delta_x = 0;
+    r.e->delta_y = 0;
+    r.motion.was_moving = r.motion.moving;
+    r.control.next = r.e->state;
+}
 
-    /*one time smart sound on*/
-    if ((delta_x != 0 || delta_y != 0) && !moving) {
+void enemy::end_think(const ai_row& r, float dt) {
+    enemy* e = r.e;
+    bool& moving = r.motion.moving;
+    /*one time smart animation on*/
+    if ((e->delta_x != 0 || e->delta_y != 0) && !moving) {
         moving = true;
-        loop_animation(0.04f);
-        CHL::play_always_s(steps_source);
+        e->loop_animation(0.04f);
     }
 
-    if (delta_x == 0 && delta_y == 0 && moving) {
+    if (e->delta_x == 0 && e->delta_y == 0 && moving) {
         moving = false;
-        loop_animation(0.0f);
-        selected_tileset = 0;
-        CHL::stop_s(steps_source);
+        e->loop_animation(0.0f);
+        e->selected_tileset = 0;
     }
 
+    /*textures and points update*/
+    e->update_points();
+    e->update();
+    e->position.z_index = e->position.y;
+
+    do_actions(r, dt);
+}
+
+void enemy::translate(const CHL::point& d) {
+    ai_row r = enemy_states.row_of(this);
+    position.x += d.x;
+    position.y += d.y;
+    position.z_index = position.y;
+    r.target.destination.x += d.x;
+    r.target.destination.y += d.y;
+    r.target.step.x += d.x;
+    r.target.step.y += d.y;
+    r.shot.from.x += d.x;
+    r.shot.from.y += d.y;
+    visor_light->position.x += d.x;
+    visor_light->position.y += d.y;
+    update_points();
+}
+
+void enemy::coast(const ai_row& r, float dt) {
+    enemy* e = r.e;
+    const CHL::point& step = r.target.step;
+    e->delta_x = 0;
+    e->delta_y = 0;
+    r.motion.was_moving = r.motion.moving;
+
+    /*the angle of the last think is the one it walks and looks at. Stop at
+     * the step destination, the next think finds a new one.*/
+    if (r.motion.moving && (std::fabs(e->position.x - step.x) >= 3.0f ||
+                            std::fabs(e->position.y - step.y) >= 3.0f)) {
+        float path = e->speed * dt;
+        e->delta_x = path * std::cos(r.motion.alpha);
+        e->delta_y = -path * std::sin(r.motion.alpha);
+        e->position.x += e->delta_x;
+        e->position.y += e->delta_y;
+    }
+
+    e->update_points();
+    e->update();
+    e->position.z_index = e->position.y;
+
+    do_actions(r, dt);
+}
+
+void enemy::apply() {
+    ai_row r = enemy_states.row_of(this);
+    if (r.motion.moving && !r.motion.was_moving)
+        CHL::play_always_s(steps_source);
+    if (!r.motion.moving && r.motion.was_moving)
+        CHL::stop_s(steps_source);
+
     /*update the position of the sound source and calculate gain of the sound
      * using the linear model*/
     CHL::set_pos_s(steps_source, CHL::vec3(position.x, position.y, 0.0f));
@@ -239,43 +367,42 @@ void enemy::move(float dt) {
 
     CHL::set_volume_s(steps_source, gain);
 
-    /*textures and points update*/
-    update_points();
-    update();
-    position.z_index = position.y;
     visor_light->position.x = position.x + 6 + light_offset.x;
     visor_light->position.y = position.y - 6 + light_offset.y;
 
-    do_actions(this, dt);
+    if (!r.shot.pending)
+        return;
+    r.shot.pending = false;
+
+    /*creating a new bullet*/
+    bullets.spawn(r.shot.from.x, r.shot.from.y, r.shot.alpha,
+                  tuning.bullet_speed, bullet_creator::enemy);
+
+    /* set the current pos as the shooting pos and calculate sound gain via
+     * the linear model*/
+    CHL::set_pos_s(fire_source, CHL::vec3(position.x, position.y, 0.0f));
+    gain = CHL::calculate_gain(CHL::gain_algorithm::linear_distance,
+                               fire_source);
+
+    CHL::set_volume_s(fire_source, gain);
+    CHL::pitch_s(fire_source, 1 + rng.range(-50, 49) / 200.0f);
+    CHL::play_s(fire_source);    // a bit of randomness in sound
 }
 
-void enemy::fire() {
-    /*if reloaded, then shoot*/
-    if (shoot_delay <= 0.0f) {
-        shoot_delay = SHOOT_DELAY;
-        shooting_point = calculate_shooting_point(this, shooting_alpha);
-
-        /*creating a new bullet*/
-        bullets.insert(bullets.end(), new bullet(position.x + shooting_point.x,
-                                                 position.y + shooting_point.y,
-                                                 0.0f, 4, 2, 0, 2));
-        auto last_bullet = bullets.end() - 1;    // getting the iterator
-        (*last_bullet)->alpha = calculate_alpha_precision(
-            shooting_alpha +
-            (rand() % 400 - 200) / 1500.0f);    // a bit of randomness in
-                                                // shooting and calculating the
-                                                // angle precision
-        (*last_bullet)->speed = B_SPEED;
-        (*last_bullet)->creator = bullet_creator::enemy;
-
-        /* set the current pos as the shooting pos and calculate sound gain via
-         * the linear model*/
-        CHL::set_pos_s(fire_source, CHL::vec3(position.x, position.y, 0.0f));
-        float gain = CHL::calculate_gain(CHL::gain_algorithm::linear_distance,
-                                         fire_source);
-
-        CHL::set_volume_s(fire_source, gain);
-        CHL::pitch_s(fire_source, 1 + (rand() % 100 - 50) / 200.0f);
-        CHL::play_s(fire_source);    // a bit of randomness in sound
+void enemy::fire(const ai_row& r) {
+    /*if reloaded, then shoot. The bullet is spawned by apply().*/
+    if (r.timers.shoot <= 0.0f) {
+        enemy* e = r.e;
+        r.timers.shoot = tuning.enemy_shoot_delay;
+        CHL::point shooting_point =
+            calculate_shooting_point(e, r.motion.alpha);
+        r.shot.from = CHL::point(e->position.x + shooting_point.x,
+                                 e->position.y + shooting_point.y);
+
+        /*a bit of randomness in shooting and calculating the angle
+         * precision*/
+        r.shot.alpha = calculate_alpha_precision(
+            r.motion.alpha + e->rng.range(-200, 199) / 1500.0f);
+        r.shot.pending = true;
     }
 }
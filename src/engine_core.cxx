@@ -0,0 +1,446 @@
+/*
+ * Engine core of the game "Chlorine-5": cameras, instances, collisions and
+ * math. It needs neither SDL, OpenGL nor OpenAL (glm is only math), so the game
+ * simulation runs with any backend, the SDL one in engine.cxx or the null one.
+ */
+#include "include/engine.hxx"
+#include "include/engine_internal.hxx"
+
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+#include <array>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace CHL {
+
+/*simple quad data with texture coordinates*/
+std::vector<float> quad_data{
+    0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+    0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+    1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f};
+
+/*this variables are needed inside the engine*/
+int t_size;
+int w_w, w_h;
+int virtual_w = 0;
+int virtual_h = 0;
+int FPS;
+
+engine::engine() {}
+engine::~engine() {}
+
+bool check_collision(instance* one,
+                     instance* two)    // AABB - AABB collision
+{
+    // collision x-axis?
+    float precision = 0.1f;
+
+    bool collisionX =
+        one->position.x + one->collision_box_offset.x + one->collision_box.x >
+            two->position.x + two->collision_box_offset.x + precision &&
+        two->position.x + two->collision_box.x + two->collision_box_offset.x >
+            one->position.x + one->collision_box_offset.x + precision;
+    // collision y-axis?
+    bool collisionY =
+        one->position.y - one->collision_box_offset.y - one->collision_box.y <
+            two->position.y - two->collision_box_offset.y - precision &&
+        two->position.y - two->collision_box_offset.y - two->collision_box.y <
+            one->position.y - one->collision_box_offset.y - precision;
+
+    return collisionX && collisionY;
+}
+
+camera::camera(int w, int h, int b_w, int b_h, instance* object) {
+    width = w;
+    height = h;
+    border_width = b_w;
+    border_height = b_h;
+    bind_object = object;
+}
+
+camera::~camera() {}
+
+void camera::update_center() {
+    /*precision added to get rid of the annoyng tile breaking lines*/
+    float precision = 0.01f;
+    if (bind_object->position.x + t_size / 2 > width / 2 &&
+        bind_object->position.x + t_size / 2 < border_width - width / 2)
+        center.x =
+            std::floor((bind_object->position.x + t_size / 2 - width / 2) /
+                       precision) *
+            precision;
+    else if (bind_object->position.x + t_size / 2 >= border_width - width / 2)
+        center.x = border_width - width;
+
+    if (bind_object->position.y - t_size / 2 > height / 2 &&
+        bind_object->position.y - t_size / 2 < border_height - height / 2)
+        center.y =
+            std::floor((bind_object->position.y - t_size / 2 - height / 2) /
+                       precision) *
+            precision;
+    else if (bind_object->position.y - t_size / 2 >= border_height - height / 2)
+        center.y = border_height - height;
+}
+point camera::get_center() {
+    return center;
+}
+
+instance::instance(float x, float y, float z, int s) {
+    position = vertex_2d(x, y, 0.0f, 0.0f);
+    position.z_index = z;
+    size.x = s;
+    size.y = s;
+    collision_box = point(s, s);
+
+    update_points();
+    update_data();
+}
+
+instance::instance(float x, float y, float z, int size_x, int size_y)
+    : instance(x, y, z, 0) {
+    size.x = size_x;
+    size.y = size_y;
+
+    collision_box = point(size_x, size_y);
+}
+
+void instance::update_points() {
+    update_data();
+
+    glm::mat4 transform;
+    transform = glm::rotate(transform,
+                            /*(GLfloat)GL_time() * */
+                            alpha, glm::vec3(0.0f, 0.0f, 1.0f));
+
+    float pixel_precision = 1.0f;
+    mesh_points[0].x = 0 + collision_box_offset.x;
+    mesh_points[0].y = 0 - collision_box_offset.y;
+
+    mesh_points[1].x = 0 + collision_box_offset.x;
+    mesh_points[1].y =
+        -collision_box.y - collision_box_offset.y + pixel_precision;
+
+    mesh_points[2].x =
+        collision_box.x + collision_box_offset.x - pixel_precision;
+    mesh_points[2].y =
+        -collision_box.y - collision_box_offset.y + pixel_precision;
+
+    mesh_points[3].x =
+        collision_box.x + collision_box_offset.x - pixel_precision;
+    mesh_points[3].y = 0 - collision_box_offset.y;
+
+    for (int i = 0; i < 4; i++) {
+        glm::vec4 vector =
+            glm::vec4(mesh_points[i].x, mesh_points[i].y, 0.0f, 0.0f) *
+            transform;
+
+        mesh_points[i].x = vector.x;
+        mesh_points[i].y = vector.y;
+
+        mesh_points[i].x += position.x;
+        mesh_points[i].y += position.y;
+    }
+}
+
+/*update the animation*/
+void instance::update() {
+    if ((animation_playing || animation_loop) && delay <= 0) {
+        update_data();
+        delay = delta_frame * FPS;
+        selected_frame += 1;
+        if (selected_frame == frames_in_animation) {
+            selected_frame = 0;
+            if (animation_playing) {
+                animation_playing = false;
+                selected_tileset = prev_tileset;
+            }
+        }
+    } else if (animation_playing || animation_loop)
+        delay -= 1;
+}
+
+void instance::play_animation(float seconds_betweeen_frames) {
+    play_animation(seconds_betweeen_frames, selected_tileset);
+}
+
+void instance::play_animation(float seconds_betweeen_frames, int tileset) {
+    selected_tileset = tileset % tilesets_in_texture;
+    prev_tileset = tileset % tilesets_in_texture;
+    animation_playing = true;
+    delta_frame = seconds_betweeen_frames;
+    delay = delta_frame * FPS;
+}
+
+void instance::loop_animation(float seconds_betweeen_frames) {
+    loop_animation(seconds_betweeen_frames, selected_tileset);
+}
+
+void instance::loop_animation(float seconds_betweeen_frames,
+                              int tileset /*tileset, from which we begin*/) {
+    selected_tileset = tileset % tilesets_in_texture;
+    delta_frame = seconds_betweeen_frames;
+    delay = delta_frame * FPS;
+    animation_loop ^= 1;
+}
+
+std::vector<float> instance::get_data() {
+    return data;
+}
+
+/*update texture and vertex coordinates of the instance*/
+void instance::update_data() {
+    data = quad_data;
+    float k_x = 1.0f / frames_in_texture;
+    float k_y = 1.0f / tilesets_in_texture;
+
+    glm::mat4 transform;
+    transform = glm::rotate(transform,
+                            /*(GLfloat)GL_time() * */
+                            -alpha, glm::vec3(0.0f, 0.0f, 1.0f));
+
+    for (size_t i = 0; i < quad_data.size(); i += STRIDE_ELEMENTS) {
+        data[i] *= (size.x / t_size);
+        data[i + 1] *= (size.y / t_size);
+        if (alpha != 0) {
+            glm::vec4 vector =
+                glm::vec4(data[i], data[i + 1], 0.0f, 0.0f) * transform;
+
+            data[i] = vector.x;
+            data[i + 1] = vector.y;
+
+            data[i] += position.x / t_size;
+            data[i + 1] -= position.y / t_size;
+        } else {
+            data[i] += position.x / t_size;
+            data[i + 1] -= position.y / t_size;
+        }
+        data[i + 2] = glm::clamp(position.z_index, MAX_DEPTH, MIN_DEPTH) /
+                      2.0f / MAX_DEPTH;
+
+        data[i + 3] *= k_x;
+        data[i + 3] += k_x * (selected_frame % frames_in_texture);
+
+        data[i + 4] *= k_y;
+        data[i + 4] += k_y * (selected_tileset % tilesets_in_texture);
+    }
+}
+
+/*similar to the instance::update_data, but used to update coordinates for the
+ * window, not the virtual world.*/
+void ui_element::update_data() {
+    data = quad_data;
+    float k_x = 1.0f / frames_in_texture;
+    float k_y = 1.0f / tilesets_in_texture;
+
+    glm::mat4 transform;
+    transform = glm::rotate(transform,
+                            /*(GLfloat)GL_time() * */
+                            -alpha, glm::vec3(0.0f, 0.0f, 1.0f));
+
+    for (size_t i = 0; i < quad_data.size(); i += STRIDE_ELEMENTS) {
+        data[i] *= (size.x / w_w);
+        data[i + 1] *= (size.y / w_h);
+        if (alpha != 0) {
+            glm::vec4 vector =
+                glm::vec4(data[i], data[i + 1], 0.0f, 0.0f) * transform;
+
+            data[i] = vector.x;
+            data[i + 1] = vector.y;
+
+            data[i] += position.x / w_w;
+            data[i + 1] -= position.y / w_h;
+        } else {
+            data[i] += position.x / w_w;
+            data[i + 1] -= position.y / w_h;
+        }
+        data[i + 2] = glm::clamp(position.z_index, MAX_DEPTH, MIN_DEPTH) /
+                      2.0f / MAX_DEPTH;
+
+        data[i + 3] *= k_x;
+        data[i + 3] += k_x * (selected_frame % frames_in_texture);
+
+        data[i + 4] *= k_y;
+        data[i + 4] += k_y * (selected_tileset % tilesets_in_texture);
+    }
+}
+
+ui_element::ui_element(float x,
+                       float y,
+                       float z,
+                       int size_x,
+                       int size_y,
+                       texture* texture)
+    : instance(x, y, z, size_x, size_y) {
+    tex = texture;
+}
+
+ui_element::ui_element(float x,
+                       float y,
+                       float z,
+                       int size_x,
+                       int size_y,
+                       texture* texture,
+                       const std::string& t,
+                       font* font)
+    : ui_element(x, y, z, size_x, size_y, texture) {
+    f = font;
+    text = t;
+}
+
+ui_element::~ui_element() {}
+
+life_form::life_form(float x, float y, float z, int _speed, int size)
+    : instance(x, y, z, size) {
+    speed = _speed;
+}
+
+instance::~instance() {
+    data.clear();
+}
+
+life_form::~life_form() {}
+
+light::light(float rad, point pos, vec3 col) {
+    radius = rad;
+    position = pos;
+    color = col;
+}
+
+light::~light() {}
+
+user_interface::user_interface() {}
+
+user_interface::~user_interface() {
+    std::vector<ui_element*>::iterator e = user_interface_elements.begin();
+    for (; e != user_interface_elements.end(); ++e) {
+        delete *e;
+        user_interface_elements.erase(e);
+    }
+}
+
+void user_interface::add_instance(ui_element* e) {
+    user_interface_elements.insert(user_interface_elements.end(), e);
+}
+
+float triangle_area(point a, point b, point c) {
+    return (a.x - c.x) * (b.y - c.y) - (a.y - c.y) * (b.x - c.x);
+}
+
+/*check for line intersection*/
+bool line_intersect(point a, point b, point c, point d, point* p) {
+    float a1 = triangle_area(a, b, d);
+    float a2 = triangle_area(a, b, c);
+
+    float t;
+    if (a1 * a2 < 0.0f) {
+        float a3 = triangle_area(c, d, a);
+        float a4 = a3 + a2 - a1;
+        if (a3 * a4 < 0.0f) {
+            if (p != nullptr) {
+                t = a3 / (a3 - a4);
+                p->x = a.x + t * (b.x - a.x);
+                p->y = a.y + t * (b.y - a.y);
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*for each line check intercection*/
+bool check_slow_collision(instance* one, instance* two, point* intersection_p) {
+    if (std::fabs(one->position.x - two->position.x) > 3 * t_size &&
+        std::fabs(one->position.y - two->position.y) > 3 * t_size)
+        return false;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            if (line_intersect(one->mesh_points[i],
+                               one->mesh_points[(i + 1) % 4],
+                               two->mesh_points[j],
+                               two->mesh_points[(j + 1) % 4], intersection_p)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*simple math functions*/
+float get_direction(float x1, float y1, float x2, float y2) {
+    float dx = x1 - x2;
+    float dy = y2 - y1;
+
+    /*the same point has no direction, 0/0 would spread NaN*/
+    if (dx == 0 && dy == 0)
+        return 0.0f;
+    if (dx >= 0 && dy >= 0)
+        return std::atan((float)dy / dx);
+    else if (dx >= 0 && dy < 0)
+        return (std::atan((float)dy / dx) + 2 * M_PI);
+    else
+        return (M_PI + std::atan((float)dy / dx));
+}
+
+float get_distance(float x1, float y1, float x2, float y2) {
+    float dx = x1 - x2;
+    float dy = y2 - y1;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+bool ray_cast(const point& p1,
+              const point& p2,
+              const std::vector<instance*>& map) {
+    for (instance* inst : map) {
+        for (int i = 0; i < 4; i++) {
+            if (line_intersect(inst->mesh_points[i],
+                               inst->mesh_points[(i + 1) % 4], p1, p2,
+                               nullptr)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool ray_cast(instance* mesh,
+              const point& p2,
+              const std::vector<instance*>& map) {
+    for (instance* inst : map) {
+        for (int j = 0; j < 4; j++) {
+            for (int i = 0; i < 4; i++) {
+                if (line_intersect(inst->mesh_points[i],
+                                   inst->mesh_points[(i + 1) % 4],
+                                   mesh->mesh_points[j], p2, nullptr)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool ray_cast(instance* mesh_one,
+              instance* mesh_two,
+              const std::vector<instance*>& map) {
+    for (instance* inst : map) {
+        for (int k = 0; k < 4; k++) {
+            for (int j = 0; j < 4; j++) {
+                for (int i = 0; i < 4; i++) {
+                    if (line_intersect(inst->mesh_points[i],
+                                       inst->mesh_points[(i + 1) % 4],
+                                       mesh_one->mesh_points[j],
+                                       mesh_two->mesh_points[k], nullptr)) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+}    // namespace CHL
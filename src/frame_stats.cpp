@@ -0,0 +1,41 @@
+#include "include/frame_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+static const char* subsystem_names[] = {"ai", "collision", "bullets",
+                                        "effects", "render"};
+
+static_assert(sizeof(subsystem_names) / sizeof(subsystem_names[0]) ==
+                  static_cast<int>(subsystem::count),
+              "every subsystem needs a name");
+
+double frame_stats::now() {
+    std::chrono::duration<double, std::milli> t =
+        std::chrono::steady_clock::now().time_since_epoch();
+    return t.count();
+}
+
+void frame_stats::report(std::ostream& out) const {
+    out << "subsystem     samples   mean ms    p50 ms    p99 ms    max ms"
+        << std::endl;
+    for (int i = 0; i < static_cast<int>(subsystem::count); i++) {
+        if (samples[i].empty())
+            continue;
+
+        std::vector<float> sorted = samples[i];
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (float ms : sorted)
+            sum += ms;
+        size_t n = sorted.size();
+
+        out << std::left << std::setw(12) << subsystem_names[i] << std::right
+            << std::setw(9) << n << std::fixed << std::setprecision(4)
+            << std::setw(10) << sum / n << std::setw(10) << sorted[n / 2]
+            << std::setw(10) << sorted[(n - 1) * 99 / 100] << std::setw(10)
+            << sorted.back() << std::endl;
+        out.unsetf(std::ios_base::floatfield);
+    }
+}
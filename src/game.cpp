@@ -5,6 +5,7 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <math.h>
 #include <cstdlib>
 #include <time.h>
@@ -13,26 +14,82 @@
 
 #include "dungeon.cpp"
 
-#include "include/autotile.hxx"
-#include "include/bullet.h"
-#include "include/collision_solves.hxx"
+#include "include/chunk_streamer.h"
 #include "include/display.h"
 #include "include/enemy.h"
 #include "include/engine.hxx"
 #include "include/global_data.h"
-#include "include/pathfinders.h"
+#include "include/input_log.h"
+#include "include/map_file.h"
 #include "include/player.h"
-#include "include/special_effect.h"
+#include "include/scenario.h"
+#include "include/world.h"
 
 enum class mode { render, look, idle };
 
-int main(int /*argc*/, char* /*argv*/ []) {
+/* longer frames are cut, so the simulation slows down instead of taking more
+ * and more steps to catch up */
+static constexpr float MAX_FRAME_TIME = 0.25f;    // seconds
+
+int main(int argc, char* argv[]) {
     using namespace CHL;
+    /* usage: Chlorine-5 [scenario options] [map file] [input log]
+     *        Chlorine-5 --endless 1 [scenario options] [input log] */
+    scenario s;
+    std::vector<std::string> args;
+    if (!s.parse(argc, argv, args))
+        return EXIT_FAILURE;
+    tuning = s.tuning;
+    s.print(std::cout);
+
+    /* the first argument is the map file. Load the dungeon from it, or
+     * generate a new one and save it there if the file is missing. A file
+     * that is there but cannot be used is never overwritten. The endless
+     * dungeon has no map file, its chunks are made from the seed. */
+    DungeonGenerator generator(s.map_width, s.map_height);
+    Map map;
+    int seed;
+    mapped_map map_file;
+    bool map_exists = !s.endless && args.size() > 0 &&
+                      std::ifstream(args[0].c_str()).good();
+    if (map_exists) {
+        if (!map_file.open(args[0])) {
+            std::cerr << "cannot load map file " << args[0]
+                      << ", it is left as it is" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (map_file.x_size() != s.map_width ||
+            map_file.y_size() != s.map_height) {
+            std::cerr << "map file " << args[0] << " is " << map_file.x_size()
+                      << "x" << map_file.y_size() << ", pass --map_width "
+                      << map_file.x_size() << " --map_height "
+                      << map_file.y_size() << " to play it" << std::endl;
+            return EXIT_FAILURE;
+        }
+        map = map_file.to_map();
+        seed = map_file.seed();
+        std::cout << seed << std::endl;
+    } else if (s.endless) {
+        seed = s.seed != 0 ? s.seed : generator.Seed;
+        std::cout << seed << std::endl;
+    } else {
+        if (s.seed != 0) {
+            map = generator.Generate(s.seed);
+            generator.Seed = s.seed;
+        } else {
+            map = generator.Generate();
+        }
+        seed = generator.Seed;
+        if (args.size() > 0)
+            write_map_file(args[0], map, generator.Seed);
+    }
+    map_file.close();
+
     /*initializing the CHL engine*/
     std::unique_ptr<engine, void (*)(engine*)> eng(create_engine(),
                                                    destroy_engine);
     int WINDOW_WIDTH, WINDOW_HEIGHT;
-    eng->CHL_init(&WINDOW_WIDTH, &WINDOW_HEIGHT, TILE_SIZE, FPS);
+    eng->CHL_init(&WINDOW_WIDTH, &WINDOW_HEIGHT, TILE_SIZE, TICK_RATE);
     eng->set_virtual_world(VIRTUAL_WIDTH, VIRTUAL_HEIGHT);
 
     /* loading font */
@@ -80,105 +137,45 @@ int main(int /*argc*/, char* /*argv*/ []) {
     */
     ui->add_instance(health_bar);
 
-    DungeonGenerator generator(x_size, y_size);
-    auto map = generator.Generate();
-    std::vector<int> tile_set = map.Print();
-
-    bool placed = false;
-    player* hero = new player(0.0f, 7.0f, 0.0f, P_SPEED, TILE_SIZE);
-
-    hero->register_keys(CHL::event::up_pressed, CHL::event::down_pressed,
-                        CHL::event::left_pressed, CHL::event::right_pressed,
-                        CHL::event::left_mouse_pressed,
-                        CHL::event::button1_pressed,
-                        CHL::event::button2_pressed, CHL::event::turn_off);
-
-    camera* main_camera = new camera(WINDOW_WIDTH / 8, WINDOW_HEIGHT / 8,
-                                     VIRTUAL_WIDTH, VIRTUAL_HEIGHT, hero);
-    entities.insert(entities.end(), hero);
-    /* generate dungeon and place character */
-
-    instance*** grid;
-    grid = new instance**[y_size];
-    for (int i = 0; i < y_size; i++)
-        grid[i] = new instance*[x_size];
-
-    int** map_grid;
-    map_grid = new int*[y_size];
-    for (int i = 0; i < y_size; i++)
-        map_grid[i] = new int[x_size];
-
-    std::vector<instance*> floor;
-    for (int y = 0; y < y_size; y++) {
-        for (int x = 0; x < x_size; x++) {
-            grid[y][x] = nullptr;
-            map_grid[y][x] = *(tile_set.begin() + y * x_size + x);
-            if (*(tile_set.begin() + y * x_size + x) != 0) {
-                bricks.insert(
-                    bricks.end(),
-                    new instance(x * TILE_SIZE, y * TILE_SIZE + TILE_SIZE, 1.0f,
-                                 TILE_SIZE));
-                (*(bricks.end() - 1))->frames_in_texture = 13;
-                (*(bricks.end() - 1))->tilesets_in_texture = 3;
-                (*(bricks.end() - 1))->selected_frame = default_frame;
-                (*(bricks.end() - 1))->selected_tileset = default_tileset;
-                (*(bricks.end() - 1))->update_data();
-                grid[y][x] = *(bricks.end() - 1);
-            } else {
-                floor.insert(
-                    floor.end(),
-                    new instance(x * TILE_SIZE, y * TILE_SIZE + TILE_SIZE,
-                                 MAX_DEPTH, TILE_SIZE));
-                (*(floor.end() - 1))->frames_in_texture = 8;
-                (*(floor.end() - 1))->selected_frame = rand() % 8;
-                (*(floor.end() - 1))->update_data();
-            }
-            if (!placed && *(tile_set.begin() + y * x_size + x) == 0) {
-                hero->position.x = x * TILE_SIZE;
-                hero->position.y = y * TILE_SIZE + TILE_SIZE;
-                placed = true;
-                *(tile_set.begin() + y * x_size + x) = 1;
-            }
+    /* generate dungeon and place characters. The same map file replays the
+     * same enemies too. The endless level streams its chunks around the
+     * camera. */
+    std::unique_ptr<chunk_streamer> streamer;
+    std::unique_ptr<world> run;
+    try {
+        if (s.endless) {
+            streamer.reset(new chunk_streamer(seed, STREAM_RADIUS));
+            run.reset(new world(*streamer, seed, s.enemies, s.threads));
+        } else {
+            run.reset(new world(map, seed, s.enemies, s.threads));
         }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "cannot start the game: " << e.what() << std::endl;
+        return EXIT_FAILURE;
     }
+    world& game_world = *run;
+    game_world.ai.enabled = s.ai_lod;
+    chunk_coord drawn_origin = game_world.origin;    // of the level buffers
+
+    /* the argument after the map file is the input log. The session is
+     * recorded there, chlorine_headless runs it again. */
+    const size_t log_arg = s.endless ? 0 : 1;
+    const char* input_log =
+        args.size() > log_arg ? args[log_arg].c_str() : nullptr;
+    input_recorder recorder;
+    player* hero = game_world.hero;
 
-    autotile(map_grid, grid, x_size, y_size);
-
-    /* place enemies */
-    std::vector<enemy*> enemies;
-
-    int map_grid_pf[x_size * y_size];
-    int count = 0;
-    int dest = 5;
-
-    while (count < dest) {
-        int x = rand() % x_size;
-        int y = rand() % y_size;
-        if (*(tile_set.begin() + y * x_size + x) != 1) {
-            entities.insert(
-                entities.end(),
-                new enemy(x * TILE_SIZE, y * TILE_SIZE + TILE_SIZE - 2, 0.0f,
-                          P_SPEED, TILE_SIZE));
-
-            dynamic_cast<enemy*>(*(entities.end() - 1))->map = map_grid_pf;
-            dynamic_cast<enemy*>(*(entities.end() - 1))->destination.x =
-                hero->position.x;
-            dynamic_cast<enemy*>(*(entities.end() - 1))->destination.y =
-                hero->position.y;
-            *(tile_set.begin() + y * x_size + x) = 1;
-            count++;
-        }
-    }
+    camera* main_camera = new camera(WINDOW_WIDTH / 8, WINDOW_HEIGHT / 8,
+                                     world_width, world_height, hero);
+    std::vector<instance*>& floor = game_world.lvl.floor;
 
     float prev_frame = eng->GL_time();
     bool quit = false;
-    bool win = false;
-    bool loose = false;
-
-    // vector for bullet destructions
-    std::vector<special_effect*> se;
 
-    convert2d_array(map_grid, map_grid_pf, x_size, y_size);
+    /* simulation time not stepped yet, always less than one step */
+    const float step_time = 1.0f / TICK_RATE;
+    float accumulator = 0.0f;
+    float played = 0.0f;    // simulated seconds, for the scenario duration
 
     /* animation test, easter egg from the duelyst. */
     instance* animated_block =
@@ -219,8 +216,9 @@ int main(int /*argc*/, char* /*argv*/ []) {
 
     /* running game loop */
     while (!quit) {
-        /*calculate delta_time for each frame to move smoothly*/
-        float delta_time = (eng->GL_time() - prev_frame);
+        /*the frame time is paid with fixed steps of the simulation*/
+        float delta_time =
+            std::min(eng->GL_time() - prev_frame, MAX_FRAME_TIME);
         prev_frame = eng->GL_time();
         event e;
 
@@ -246,138 +244,46 @@ int main(int /*argc*/, char* /*argv*/ []) {
                 hero->keys[static_cast<int>(e) - 1] = false;
             }
         }
-        hero->move(delta_time);
 
         /*calculate angle*/
         hero->mouth_cursor.x = eng->get_mouse_pos(main_camera).x;
         hero->mouth_cursor.y = eng->get_mouse_pos(main_camera).y;
 
-        /* check collisions */
-
-        /// player & enemy collisions to walls
-        for (life_form* lf : entities) {
-            lf->position.z_index = lf->position.y;
-            enemy* e = dynamic_cast<enemy*>(lf);
-            if (e != nullptr) {
-                e->move(delta_time);
-                e->destination.x = hero->position.x + TILE_SIZE / 2;
-                e->destination.y = hero->position.y - TILE_SIZE / 4;
-            }
-            for (instance* inst : bricks) {
-                if (check_collision(lf, inst)) {
-                    solve_dynamic_to_static_collision_fast(
-                        lf, inst, lf->delta_x, lf->delta_y);
-                }
-            }
+        accumulator += delta_time;
+        while (accumulator >= step_time) {
+            if (input_log != nullptr)
+                recorder.record(hero);
+            game_world.step(step_time);
+            animated_block->update();
+            accumulator -= step_time;
+            played += step_time;
         }
-
-        // here I have a big problems with the architecture of my game, and here
-        // is a quite complex algorithm. But everything is clear, if you
-        // read it line by line
-
-        hero->update_points();
-        for (auto b = bullets.begin(); b != bullets.end();) {
-            // destroy bullet if it is outside the world.
-            if ((*b)->position.x + TILE_SIZE < 0 ||
-                (*b)->position.x > VIRTUAL_WIDTH + TILE_SIZE ||
-                (*b)->position.y + TILE_SIZE < 0 ||
-                (*b)->position.y > VIRTUAL_HEIGHT + TILE_SIZE) {
-                delete *b;
-                b = bullets.erase(b);
-                continue;    // it is like our goto, but here we cannot access
-                             // it.
-            }
-
-            (*b)->update_points();
-            point* intersection_point = new point();
-
-            for (auto en = entities.begin(); en != entities.end();) {
-                // check collision with entities and do some entity related
-                // stuff
-                if (check_slow_collision(*b, *en, intersection_point)) {
-                    if (dynamic_cast<enemy*>(*en) != nullptr &&
-                        (*b)->creator != bullet_creator::enemy) {
-                        delete *b;
-                        b = bullets.erase(b);
-
-                        if (--(*en)->health <= 0) {
-                            hero->blink_to(
-                                point((*en)->position.x, (*en)->position.y));
-                            hero->health = std::min(hero->health + 1, 5);
-                            health_bar->selected_tileset = hero->health;
-                            delete *en;
-                            entities.erase(en);
-                            bool exit = true;
-                            for (auto inst :
-                                 entities) {    // checking for
-                                                // enemies on the map
-                                if (dynamic_cast<enemy*>(inst) != nullptr) {
-                                    exit = false;
-                                }
-                            }
-                            if (exit)
-                                win = true;
-                        }
-
-                        se.insert(se.end(),
-                                  new special_effect(
-                                      intersection_point->x - TILE_SIZE / 4 - 1,
-                                      intersection_point->y + TILE_SIZE / 4 + 1,
-                                      MIN_DEPTH, TILE_SIZE / 2 + 2));
-                        (*(se.end() - 1))->frames_in_texture = 8;
-                        goto loop_end;
-                    } else if (dynamic_cast<player*>(*en) != nullptr &&
-                               (*b)->creator == bullet_creator::enemy) {
-                        delete *b;
-                        b = bullets.erase(b);
-
-                        health_bar->selected_tileset--;
-                        se.insert(se.end(),
-                                  new special_effect(
-                                      intersection_point->x - TILE_SIZE / 4 - 1,
-                                      intersection_point->y + TILE_SIZE / 4 + 1,
-                                      MIN_DEPTH, TILE_SIZE / 2 + 2));
-                        (*(se.end() - 1))->frames_in_texture = 8;
-                        if (--(*en)->health <= 0) {
-                            loose = true;
-                        }
-                        goto loop_end;
-                    }
-                }
-                ++en;
-            }
-
-            for (instance* brick : bricks) {
-                if (check_slow_collision(*b, brick, intersection_point)) {
-                    delete *b;
-                    b = bullets.erase(b);
-
-                    se.insert(se.end(),
-                              new special_effect(
-                                  intersection_point->x - TILE_SIZE / 4 - 1,
-                                  intersection_point->y + TILE_SIZE / 4 + 1,
-                                  MIN_DEPTH, TILE_SIZE / 2 + 2));
-                    (*(se.end() - 1))->frames_in_texture = 8;
-
-                    goto loop_end;
-                }
+        if (s.duration > 0.0f && played >= s.duration)
+            quit = true;
+
+        /* the endless level moved under the camera, its tiles are new */
+        if (streamer != nullptr) {
+            if (!(game_world.origin == drawn_origin)) {
+                eng->clear_buffer("bricks");
+                eng->clear_buffer("floor");
+                for (auto brick : bricks)
+                    eng->add_to_buffer("bricks", brick);
+                for (auto tile : floor)
+                    eng->add_to_buffer("floor", tile);
+                drawn_origin = game_world.origin;
             }
-            ++b;
-        loop_end:    // I think that goto sometimes isn't bad at all.
-            continue;
+            streamer->update(main_camera, game_world.origin);
         }
+        health_bar->selected_tileset = game_world.hud_health;
 
-        for (auto s = se.begin(); s != se.end();) {
-            if ((*s)->end()) {
-                delete *s;
-                s = se.erase(s);
-                continue;
-            }
-            ++s;
-        }
+        /* what is left of the accumulator is how far the frame is between the
+         * last step and the next one */
+        float blend = accumulator / step_time;
+        game_world.interpolate(blend);
 
         float fixed_time = (eng->GL_time() - prev_frame) * 1000.0f;
         std::cout << "time for processing: " << fixed_time << std::endl;
+        double render_start = frame_stats::now();
 
         /* render sprites */
 
@@ -397,10 +303,7 @@ int main(int /*argc*/, char* /*argv*/ []) {
         float bricks_t = (eng->GL_time() - prev_frame) * 1000.0f - floor_t;
         std::cout << "time for rendering bricks: " << bricks_t << std::endl;
 
-        for (auto bullet : bullets) {
-            bullet->move(delta_time);
-            eng->add_object(bullet, main_camera);
-        }
+        bullets.render(eng.get(), main_camera, blend);
 
         if (!bullets.empty())
             eng->render(manager.get_texture("bullet"), main_camera, nullptr);
@@ -412,9 +315,9 @@ int main(int /*argc*/, char* /*argv*/ []) {
         eng->render(manager.get_texture("hero"), main_camera, nullptr);
 
         for (auto e : entities) {
-            enemy* cast = dynamic_cast<enemy*>(e);
-            if (cast != nullptr) {
-                eng->render_light(cast->visor_light, main_camera);
+            if (is_kind(e, entity_kind::enemy)) {
+                eng->render_light(static_cast<enemy*>(e)->visor_light,
+                                  main_camera);
                 eng->add_object(e, main_camera);
             }
         }
@@ -423,40 +326,28 @@ int main(int /*argc*/, char* /*argv*/ []) {
 
         float entites_t = (eng->GL_time() - prev_frame) * 1000.0f - bullets_t;
         std::cout << "time for rendering entites: " << entites_t << std::endl;
-        for (auto effect : se) {
-            effect->update_frame();
-            eng->add_object(effect, main_camera);
-        }
-
-        if (!se.empty())
-            eng->render(manager.get_texture("explosion"), main_camera, nullptr);
+        effects.render_explosions(eng.get(), main_camera,
+                                  manager.get_texture("explosion"));
 
         eng->render_ui(ui);
-        for (auto quad = non_material_quads.begin();    // player fade effect
-             quad != non_material_quads.end();) {
-            (*quad)->update_data();
-            eng->add_object(*quad, main_camera);
-            (*quad)->alpha_channel -= delta_time * 5;
-            eng->render(manager.get_texture("hero"), main_camera, *quad);
-            if ((*quad)->alpha_channel <= 0.05f) {
-                delete *quad;
-                quad = non_material_quads.erase(quad);
-                continue;
-            }
-            ++quad;
-        }
+        effects.render_fades(eng.get(), main_camera,    // player fade effect
+                             manager.get_texture("hero"), delta_time);
 
         float effects_t = (eng->GL_time() - prev_frame) * 1000.0f - entites_t;
         std::cout << "time for rendering effects: " << effects_t << std::endl;
 
         eng->render_light(hero->visor_light, main_camera);
 
-        animated_block->update();
-        eng->add_object(animated_block, main_camera);
-        eng->render(manager.get_texture("obelisk"), main_camera, nullptr);
+        /* it stands on the bounded map only, the endless one moves */
+        if (streamer == nullptr) {
+            eng->add_object(animated_block, main_camera);
+            eng->render(manager.get_texture("obelisk"), main_camera, nullptr);
+        }
+
+        game_world.restore();
 
         /* win/loose screen renders */
-        if (win) {
+        if (game_world.win) {
             display::render_screen(
                 eng.get(), manager.get_texture("win"),
                 manager.get_sound("quit_sound"), WINDOW_WIDTH / 2 - 400,
@@ -464,7 +355,7 @@ int main(int /*argc*/, char* /*argv*/ []) {
                 vec3(0.325f, 0.196f, 0.713f), event::select_pressed,
                 WINDOW_WIDTH, WINDOW_HEIGHT);
             break;
-        } else if (loose) {
+        } else if (game_world.loose) {
             display::render_screen(
                 eng.get(), manager.get_texture("loose"),
                 manager.get_sound("quit_sound"), WINDOW_WIDTH / 2 - 300,
@@ -475,6 +366,8 @@ int main(int /*argc*/, char* /*argv*/ []) {
         }
 
         eng->GL_swap_buffers();
+        game_world.stats.add(subsystem::render,
+                             frame_stats::now() - render_start);
         std::cout << "time for rendering: "
                   << (eng->GL_time() - prev_frame) * 1000.0f - fixed_time
                   << std::endl;
@@ -482,12 +375,19 @@ int main(int /*argc*/, char* /*argv*/ []) {
         /* dynamic sleep */
         float t = (eng->GL_time() - prev_frame) * 1000;
 
-        if (t > 1000 / FPS)
+        if (t > 1000.0f / FPS)
             std::cerr << "freeze" << std::endl;
-        if (t < 1000 / FPS)
+        if (t < 1000.0f / FPS)
             std::this_thread::sleep_for(
-                std::chrono::milliseconds(1000 / FPS - (int)t));
+                std::chrono::duration<float, std::milli>(1000.0f / FPS - t));
+    }
+
+    if (input_log != nullptr) {
+        scenario session = s;
+        session.seed = seed;
+        recorder.save(input_log, session, TICK_RATE);
     }
+    game_world.stats.report(std::cout);
 
     eng->CHL_exit();
     return EXIT_SUCCESS;
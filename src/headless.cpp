@@ -0,0 +1,134 @@
+/*
+ * Headless driver for the game "Chlorine-5". Steps the world on the null
+ * backend with the fixed time step of the game and no frame pacing, as fast
+ * as it goes, and reports how long the steps took. Nothing is drawn and
+ * nothing is played, so it runs on machines without a GPU or an audio device.
+ *
+ * usage: chlorine_headless [scenario options] [input log]
+ *
+ * The options are the ones of scenario.h, a run lasts 60 seconds unless the
+ * scenario says otherwise. With an input log the recorded session of the game
+ * runs again, with its seed, its scenario and the recorded input of every
+ * step, for as many steps as were recorded. Options that change the recorded
+ * scenario are refused, only the threads may differ. An endless run streams the
+ * chunks around the hero, there is no camera to follow.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dungeon.cpp"
+
+#include "include/chunk_streamer.h"
+#include "include/engine.hxx"
+#include "include/global_data.h"
+#include "include/input_log.h"
+#include "include/scenario.h"
+#include "include/world.h"
+
+int main(int argc, char* argv[]) {
+    using namespace CHL;
+    scenario s;
+    s.seed = 1;
+    s.duration = 60.0f;
+    std::vector<std::string> positional;
+    if (!s.parse(argc, argv, positional))
+        return EXIT_FAILURE;
+
+    int tick_rate = TICK_RATE;
+    int ticks = static_cast<int>(s.duration * tick_rate);
+
+    input_replay replay;
+    bool replaying = !positional.empty();
+    if (replaying) {
+        if (!replay.load(positional[0]))
+            return EXIT_FAILURE;
+        /* the options go over the recorded scenario and may only repeat it */
+        s = replay.recorded();
+        positional.clear();
+        if (!s.parse(argc, argv, positional))
+            return EXIT_FAILURE;
+        if (!s.same_run(replay.recorded())) {
+            std::cerr << "the options conflict with the input log "
+                      << positional[0] << ", it was recorded with" << std::endl;
+            replay.recorded().print(std::cerr);
+            return EXIT_FAILURE;
+        }
+        tick_rate = replay.tick_rate();
+        ticks = replay.ticks();
+    }
+    tuning = s.tuning;
+    s.print(std::cout);
+
+    std::unique_ptr<engine> eng(create_null_engine());
+    int width, height;
+    eng->CHL_init(&width, &height, TILE_SIZE, tick_rate);
+    eng->set_virtual_world(VIRTUAL_WIDTH, VIRTUAL_HEIGHT);
+
+    /* the same seed gives the same dungeon and the same run */
+    std::unique_ptr<chunk_streamer> streamer;
+    std::unique_ptr<world> run;
+    try {
+        if (s.endless) {
+            streamer.reset(new chunk_streamer(s.seed, STREAM_RADIUS));
+            run.reset(new world(*streamer, s.seed, s.enemies, s.threads));
+        } else {
+            DungeonGenerator generator(s.map_width, s.map_height);
+            run.reset(new world(generator.Generate(s.seed), s.seed, s.enemies,
+                                s.threads));
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "cannot start the run: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    world& game_world = *run;
+    game_world.ai.enabled = s.ai_lod;
+    /* charts have to be built on the enemies that really run */
+    if (live_enemies != s.enemies)
+        std::cout << "placed " << live_enemies << " of " << s.enemies
+                  << " enemies" << std::endl;
+
+    /* without a replay nobody plays, the hero stands still and the enemies
+     * come to it */
+    const float dt = 1.0f / tick_rate;
+    float start = eng->GL_time();
+    for (int i = 0; i < ticks; i++) {
+        if (replaying)
+            replay.apply(game_world.hero);
+        game_world.step(dt);
+        if (streamer != nullptr) {
+            const player* hero = game_world.hero;
+            streamer->update(
+                game_world.origin.x * CHUNK_SIZE +
+                    static_cast<int>(hero->position.x) / TILE_SIZE,
+                game_world.origin.y * CHUNK_SIZE +
+                    static_cast<int>(hero->position.y) / TILE_SIZE);
+        }
+    }
+    float elapsed = eng->GL_time() - start;
+
+    std::cout << ticks << " ticks in " << elapsed * 1000.0f << " ms, "
+              << (ticks > 0 ? elapsed * 1e6f / ticks : 0.0f)
+              << " us per tick" << std::endl;
+    std::cout << "enemies left: " << live_enemies
+              << ", bullets flying: " << bullets.size() << std::endl;
+    if (game_world.win)
+        std::cout << "the hero won" << std::endl;
+    else if (game_world.loose)
+        std::cout << "the hero lost" << std::endl;
+    uint64_t enemy_steps = game_world.ai.thought() + game_world.ai.coasted();
+    if (enemy_steps > 0)
+        std::cout << "enemies thought in " << game_world.ai.thought() << " of "
+                  << enemy_steps << " enemy steps" << std::endl;
+    if (streamer != nullptr)
+        std::cout << "endless level at chunk (" << game_world.origin.x << ", "
+                  << game_world.origin.y << "), " << streamer->resident()
+                  << " chunks resident" << std::endl;
+    game_world.stats.report(std::cout);
+
+    eng->CHL_exit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+#include "include/input_log.h"
+
+#include <fstream>
+#include <iostream>
+
+static const int KEY_COUNT = sizeof(player::keys) / sizeof(bool);
+
+static_assert(KEY_COUNT <= 32, "every key has to fit one bit of the record");
+
+void input_recorder::record(const player* hero) {
+    input_record r;
+    r.tick = tick++;
+    r.keys = 0;
+    for (int i = 0; i < KEY_COUNT; i++)
+        if (hero->keys[i])
+            r.keys |= 1u << i;
+    r.cursor_x = hero->mouth_cursor.x;
+    r.cursor_y = hero->mouth_cursor.y;
+
+    /*the same input as before is not worth a record*/
+    if (!records.empty()) {
+        const input_record& last = records.back();
+        if (last.keys == r.keys && last.cursor_x == r.cursor_x &&
+            last.cursor_y == r.cursor_y)
+            return;
+    }
+    records.push_back(r);
+}
+
+bool input_recorder::save(const std::string& path,
+                          const scenario& s,
+                          int tick_rate) const {
+    input_log_header header;
+    header.magic = INPUT_LOG_MAGIC;
+    header.version = INPUT_LOG_VERSION;
+    header.tick_rate = tick_rate;
+    header.seed = s.seed;
+    header.ticks = tick;
+    header.records = records.size();
+    header.reserved = 0;
+
+    input_log_scenario ls;
+    ls.map_width = s.map_width;
+    ls.map_height = s.map_height;
+    ls.enemies = s.enemies;
+    ls.threads = s.threads;
+    ls.ai_lod = s.ai_lod;
+    ls.endless = s.endless;
+    ls.speed = s.tuning.speed;
+    ls.bullet_speed = s.tuning.bullet_speed;
+    ls.enemy_shoot_delay = s.tuning.enemy_shoot_delay;
+    ls.hero_shoot_delay = s.tuning.hero_shoot_delay;
+    ls.enemy_health = s.tuning.enemy_health;
+    ls.hero_health = s.tuning.hero_health;
+
+    std::ofstream ofs(path.data(), std::ios_base::binary);
+    if (!ofs) {
+        std::cerr << "cannot create input log " << path << std::endl;
+        return false;
+    }
+
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(&ls), sizeof(ls));
+    ofs.write(reinterpret_cast<const char*>(records.data()),
+              records.size() * sizeof(input_record));
+    if (!ofs.good()) {
+        std::cerr << "cannot write input log " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool input_replay::load(const std::string& path) {
+    std::ifstream ifs(path.data(), std::ios_base::binary);
+    if (!ifs) {
+        std::cerr << "cannot open input log " << path << std::endl;
+        return false;
+    }
+
+    input_log_header h;
+    input_log_scenario ls;
+    if (!ifs.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+        h.magic != INPUT_LOG_MAGIC || h.tick_rate == 0) {
+        std::cerr << "invalid input log " << path << std::endl;
+        return false;
+    }
+    if (h.version != INPUT_LOG_VERSION) {
+        std::cerr << "input log " << path << " has version " << h.version
+                  << ", only " << INPUT_LOG_VERSION << " is supported"
+                  << std::endl;
+        return false;
+    }
+    if (!ifs.read(reinterpret_cast<char*>(&ls), sizeof(ls)) ||
+        ls.map_width <= 3 || ls.map_height <= 3 || ls.enemies < 0 ||
+        ls.threads < 0) {
+        std::cerr << "invalid scenario in input log " << path << std::endl;
+        return false;
+    }
+
+    /*the count comes from the file, check it before allocating for it*/
+    const std::streampos body = ifs.tellg();
+    ifs.seekg(0, std::ios_base::end);
+    const std::streamoff left = ifs.tellg() - body;
+    ifs.seekg(body);
+    if (left < 0 || static_cast<uint64_t>(left) / sizeof(input_record) <
+                        h.records) {
+        std::cerr << "truncated input log " << path << ", " << h.records
+                  << " records do not fit in " << left << " bytes"
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<input_record> r(h.records);
+    if (!ifs.read(reinterpret_cast<char*>(r.data()),
+                  r.size() * sizeof(input_record))) {
+        std::cerr << "truncated input log " << path << std::endl;
+        return false;
+    }
+
+    header = h;
+    played = scenario();
+    played.seed = h.seed;
+    played.map_width = ls.map_width;
+    played.map_height = ls.map_height;
+    played.enemies = ls.enemies;
+    played.threads = ls.threads;
+    played.ai_lod = ls.ai_lod != 0;
+    played.endless = ls.endless != 0;
+    played.tuning.speed = ls.speed;
+    played.tuning.bullet_speed = ls.bullet_speed;
+    played.tuning.enemy_shoot_delay = ls.enemy_shoot_delay;
+    played.tuning.hero_shoot_delay = ls.hero_shoot_delay;
+    played.tuning.enemy_health = ls.enemy_health;
+    played.tuning.hero_health = ls.hero_health;
+    records.swap(r);
+    tick = 0;
+    next = 0;
+    return true;
+}
+
+bool input_replay::apply(player* hero) {
+    if (tick >= header.ticks)
+        return false;
+
+    /*records are sparse, the hero keeps the input until the next one*/
+    while (next < records.size() && records[next].tick <= tick) {
+        const input_record& r = records[next++];
+        for (int i = 0; i < KEY_COUNT; i++)
+            hero->keys[i] = (r.keys >> i) & 1;
+        hero->mouth_cursor.x = r.cursor_x;
+        hero->mouth_cursor.y = r.cursor_y;
+    }
+    tick++;
+    return true;
+}
@@ -0,0 +1,122 @@
+#include "include/job_system.h"
+
+job_system::job_system(int threads) {
+    if (threads <= 0)
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0)
+        threads = 1;
+
+    for (int i = 0; i < threads; i++)
+        queues.emplace_back(new job_queue);
+    for (int i = 1; i < threads; i++)
+        workers.emplace_back(&job_system::work, this, i);
+}
+
+job_system::~job_system() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers)
+        t.join();
+}
+
+void job_system::parallel_for(
+    size_t count,
+    size_t _grain,
+    const std::function<void(size_t, size_t)>& _body) {
+    if (count == 0)
+        return;
+    if (_grain == 0)
+        _grain = 1;
+    /*nobody to share with, or not worth waking anybody*/
+    if (workers.empty() || count <= _grain) {
+        _body(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        body = &_body;
+        grain = _grain;
+        unfinished = 1;
+        {
+            std::lock_guard<std::mutex> queue_guard(queues[0]->lock);
+            queues[0]->jobs.push_back(job{0, count});
+        }
+        generation++;
+    }
+    wake.notify_all();
+
+    job j;
+    while (unfinished > 0) {
+        if (find_job(0, j))
+            run(0, j);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void job_system::work(int id) {
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&] { return stop || generation != seen; });
+            if (stop)
+                return;
+            seen = generation;
+        }
+
+        job j;
+        while (unfinished > 0) {
+            if (find_job(id, j))
+                run(id, j);
+            else
+                std::this_thread::yield();
+        }
+    }
+}
+
+bool job_system::find_job(int id, job& out) {
+    /*own work first, the newest piece is the smallest and the warmest*/
+    {
+        job_queue& own = *queues[id];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.jobs.empty()) {
+            out = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+
+    /*steal the oldest piece of somebody else, it is the biggest one*/
+    const int n = threads();
+    for (int k = 1; k < n; k++) {
+        job_queue& victim = *queues[(id + k) % n];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.jobs.empty()) {
+            out = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void job_system::run(int id, job j) {
+    /*keep the first half, leave the second one to be stolen*/
+    while (j.end - j.begin > grain) {
+        size_t mid = j.begin + (j.end - j.begin) / 2;
+        unfinished++;
+        {
+            std::lock_guard<std::mutex> guard(queues[id]->lock);
+            queues[id]->jobs.push_back(job{mid, j.end});
+        }
+        j.end = mid;
+    }
+
+    (*body)(j.begin, j.end);
+    unfinished--;
+}
@@ -0,0 +1,134 @@
+#include "include/level.h"
+
+#include <cstdlib>
+
+#include "include/autotile.hxx"
+#include "include/global_data.h"
+
+enum class wall_shape { none, full, top_half };
+
+static wall_shape shape_of(const level& lvl, int x, int y) {
+    CHL::instance* brick = lvl.cells[y * lvl.width + x];
+    if (brick == nullptr)
+        return wall_shape::none;
+    return brick->collision_box.y < TILE_SIZE ? wall_shape::top_half
+                                              : wall_shape::full;
+}
+
+/*greedy meshing: take the first free wall tile in row-major order, stretch
+ * it right as far as the shape repeats, then down while whole rows fit. Half
+ * walls cover only the upper half of their tiles, so they are merged along
+ * the row only.*/
+static void merge_walls(level& lvl) {
+    const int w = lvl.width, h = lvl.height;
+    lvl.wall_boxes.clear();
+    lvl.wall_box_of.assign(w * h, -1);
+
+    auto is_free = [&](int x, int y, wall_shape s) {
+        return shape_of(lvl, x, y) == s && lvl.wall_box_of[y * w + x] < 0;
+    };
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            wall_shape s = shape_of(lvl, x, y);
+            if (s == wall_shape::none || lvl.wall_box_of[y * w + x] >= 0)
+                continue;
+
+            int x1 = x;
+            while (x1 + 1 < w && is_free(x1 + 1, y, s))
+                x1++;
+
+            int y1 = y;
+            while (s == wall_shape::full && y1 + 1 < h) {
+                bool fits = true;
+                for (int i = x; i <= x1 && fits; i++)
+                    fits = is_free(i, y1 + 1, s);
+                if (!fits)
+                    break;
+                y1++;
+            }
+
+            const int id = lvl.wall_boxes.size();
+            for (int j = y; j <= y1; j++)
+                for (int i = x; i <= x1; i++)
+                    lvl.wall_box_of[j * w + i] = id;
+
+            /*position is the bottom left corner of the box*/
+            int box_w = (x1 - x + 1) * TILE_SIZE;
+            CHL::instance* box =
+                s == wall_shape::full
+                    ? new CHL::instance(x * TILE_SIZE, (y1 + 1) * TILE_SIZE,
+                                        1.0f, box_w, (y1 - y + 1) * TILE_SIZE)
+                    : new CHL::instance(x * TILE_SIZE,
+                                        y * TILE_SIZE + TILE_SIZE / 2, 1.0f,
+                                        box_w, TILE_SIZE / 2);
+            box->update_points();
+            lvl.wall_boxes.push_back(box);
+        }
+    }
+}
+
+/*the floor frame of the world tile, drawn from its own stream*/
+static int floor_frame(int x, int y) {
+    uint64_t tile = static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 |
+                    static_cast<uint32_t>(y);
+    return random_streams.stream(rng_system::level, tile).below(8);
+}
+
+void build_level(const Map& map, level& lvl, int origin_x, int origin_y) {
+    const int w = map.GetXSize(), h = map.GetYSize();
+    lvl.width = w;
+    lvl.height = h;
+    lvl.walls.assign(w * h, 0);
+    lvl.walkable.assign(w * h, 0);
+    lvl.cells.assign(w * h, nullptr);
+    lvl.free_cells.clear();
+    lvl.bricks.clear();
+    lvl.floor.clear();
+    lvl.wall_boxes.clear();
+
+    /*walkability of 64 tiles at a time from the packed rows, then every
+     * grid is filled in the same pass*/
+    const int bit_words = (w + 63) / 64;
+    const std::vector<uint64_t> walkable_bits = map.WalkableBits();
+    for (int y = 0; y < h; y++) {
+        const uint64_t* row = &walkable_bits[y * bit_words];
+        for (int x = 0; x < w; x++) {
+            const int i = y * w + x;
+
+            if (!(row[x / 64] >> (x % 64) & 1)) {
+                lvl.walls[i] = 1;
+
+                CHL::instance* brick =
+                    new CHL::instance(x * TILE_SIZE, y * TILE_SIZE + TILE_SIZE,
+                                      1.0f, TILE_SIZE);
+                brick->frames_in_texture = 13;
+                brick->tilesets_in_texture = 3;
+                brick->selected_frame = default_frame;
+                brick->selected_tileset = default_tileset;
+                brick->update_data();
+
+                lvl.cells[i] = brick;
+                lvl.bricks.push_back(brick);
+            } else {
+                lvl.walkable[i] = 1;
+                lvl.free_cells.push_back(i);
+
+                CHL::instance* tile =
+                    new CHL::instance(x * TILE_SIZE, y * TILE_SIZE + TILE_SIZE,
+                                      MAX_DEPTH, TILE_SIZE);
+                tile->frames_in_texture = 8;
+                tile->selected_frame = floor_frame(origin_x + x, origin_y + y);
+                tile->update_data();
+
+                lvl.floor.push_back(tile);
+            }
+        }
+    }
+
+    autotile(grid_rows<const int>{lvl.walls.data(), w},
+             grid_rows<CHL::instance*>{lvl.cells.data(), w}, w, h);
+
+    /*after autotile, it decides which walls are half-height*/
+    merge_walls(lvl);
+}
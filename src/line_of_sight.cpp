@@ -0,0 +1,114 @@
+#include "include/line_of_sight.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "include/global_data.h"
+#include "include/visibility_table.h"
+
+/*probes before the query gives up on the cache and just traces*/
+constexpr int MAX_PROBES = 8;
+
+/*layout of a cache slot*/
+constexpr int TILE_BITS = 24;
+constexpr int STAMP_BITS = 15;
+constexpr uint32_t STAMP_MASK = (1u << STAMP_BITS) - 1;
+
+line_of_sight::line_of_sight(int cache_size)
+    : cache(cache_size), mask(cache_size - 1) {
+    assert(cache_size > 0 && (cache_size & (cache_size - 1)) == 0);
+    for (std::atomic<uint64_t>& e : cache)
+        e.store(0);
+}
+
+void line_of_sight::set_map(const int* walkable, int _width, int _height) {
+    map = walkable;
+    width = _width;
+    height = _height;
+    table = nullptr;
+    new_frame();
+}
+
+void line_of_sight::new_frame() {
+    /*stamp 0 marks never written slots, skip it on the wrap*/
+    stamp = (stamp + 1) & STAMP_MASK;
+    if (stamp == 0) {
+        for (std::atomic<uint64_t>& e : cache)
+            e.store(0, std::memory_order_relaxed);
+        stamp = 1;
+    }
+}
+
+bool line_of_sight::trace(int from_x, int from_y, int to_x, int to_y) const {
+    if (!passable(from_x, from_y) || !passable(to_x, to_y))
+        return false;
+
+    int dx = std::abs(to_x - from_x), dy = std::abs(to_y - from_y);
+    int step_x = to_x > from_x ? 1 : -1;
+    int step_y = to_y > from_y ? 1 : -1;
+
+    /*walk every tile the line touches. i and j count the steps made along
+     * the axes, the sign of decision tells which tile border the line
+     * crosses first.*/
+    int x = from_x, y = from_y;
+    for (int i = 0, j = 0; i < dx || j < dy;) {
+        int decision = (1 + 2 * i) * dy - (1 + 2 * j) * dx;
+        if (decision == 0) {
+            if (!passable(x + step_x, y) || !passable(x, y + step_y))
+                return false;
+            x += step_x;
+            y += step_y;
+            i++;
+            j++;
+        } else if (decision < 0) {
+            x += step_x;
+            i++;
+        } else {
+            y += step_y;
+            j++;
+        }
+        if (!passable(x, y))
+            return false;
+    }
+    return true;
+}
+
+bool line_of_sight::visible(const CHL::point& from, const CHL::point& to) {
+    int from_x = static_cast<int>(std::floor(from.x / TILE_SIZE));
+    int from_y = static_cast<int>(std::floor(from.y / TILE_SIZE));
+    int to_x = static_cast<int>(std::floor(to.x / TILE_SIZE));
+    int to_y = static_cast<int>(std::floor(to.y / TILE_SIZE));
+
+    if (!passable(from_x, from_y) || !passable(to_x, to_y))
+        return false;
+    if (table != nullptr)
+        return table->visible(from_x, from_y, to_x, to_y);
+
+    /*tiles of huge maps do not fit in a slot*/
+    if (static_cast<int64_t>(width) * height > (1 << TILE_BITS))
+        return trace(from_x, from_y, to_x, to_y);
+
+    uint64_t key = static_cast<uint64_t>(from_y * width + from_x)
+                       << TILE_BITS |
+                   static_cast<uint32_t>(to_y * width + to_x);
+    uint32_t slot = static_cast<uint32_t>((key ^ (key >> 29)) *
+                                          0x9E3779B97F4A7C15ULL >> 32);
+    uint64_t tag = (key << STAMP_BITS | stamp) << 1;
+
+    for (int probe = 0; probe < MAX_PROBES; probe++) {
+        std::atomic<uint64_t>& e = cache[(slot + probe) & mask];
+        uint64_t v = e.load(std::memory_order_relaxed);
+        if ((v & ~1ull) == tag)
+            return v & 1;
+        if ((v >> 1 & STAMP_MASK) != stamp) {
+            /*another thread can take the slot first, then this answer is
+             * just not cached*/
+            bool visible = trace(from_x, from_y, to_x, to_y);
+            e.compare_exchange_strong(v, tag | visible,
+                                      std::memory_order_relaxed);
+            return visible;
+        }
+    }
+    return trace(from_x, from_y, to_x, to_y);
+}
@@ -0,0 +1,178 @@
+#include "include/map_file.h"
+
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(map_file_header) % sizeof(uint64_t) == 0,
+              "tile words have to stay aligned after the header");
+
+bool write_map_file(const std::string& path, const Map& map, int seed) {
+    map_file_header header;
+    header.magic = MAP_FILE_MAGIC;
+    header.version = MAP_FILE_VERSION;
+    header.tile_bits = MAP_FILE_TILE_BITS;
+    header.seed = seed;
+    header.x_size = map.GetXSize();
+    header.y_size = map.GetYSize();
+    header.row_words = map_file_row_words(header.x_size);
+
+    std::ofstream ofs(path.data(), std::ios_base::binary);
+    if (!ofs) {
+        std::cerr << "cannot create map file " << path << std::endl;
+        return false;
+    }
+
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    /*the map keeps its tiles packed exactly as the file does*/
+    ofs.write(reinterpret_cast<const char*>(map.GetRow(0)),
+              static_cast<size_t>(header.row_words) * header.y_size *
+                  sizeof(uint64_t));
+    if (!ofs.good()) {
+        std::cerr << "cannot write map file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+mapped_map::mapped_map() {}
+
+mapped_map::mapped_map(const std::string& path) {
+    open(path);
+}
+
+mapped_map::~mapped_map() {
+    close();
+}
+
+bool mapped_map::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    file_handle = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        close();
+        return false;
+    }
+    view_size = static_cast<size_t>(size.QuadPart);
+
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    mapping_handle = mapping;
+
+    view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        close();
+        return false;
+    }
+#else
+    file_descriptor = ::open(path.c_str(), O_RDONLY);
+    if (file_descriptor < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(file_descriptor, &st) != 0 || st.st_size <= 0) {
+        close();
+        return false;
+    }
+    view_size = static_cast<size_t>(st.st_size);
+
+    view = mmap(nullptr, view_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (view == MAP_FAILED) {
+        view = nullptr;
+        close();
+        return false;
+    }
+#endif
+
+    /*validate the header before the first tile is touched*/
+    const map_file_header* h = static_cast<const map_file_header*>(view);
+    if (view_size < sizeof(map_file_header) || h->magic != MAP_FILE_MAGIC ||
+        h->version != MAP_FILE_VERSION ||
+        h->tile_bits != MAP_FILE_TILE_BITS || h->x_size <= 0 ||
+        h->y_size <= 0 || h->row_words != map_file_row_words(h->x_size) ||
+        view_size < sizeof(map_file_header) +
+                        static_cast<size_t>(h->row_words) * h->y_size *
+                            sizeof(uint64_t)) {
+        std::cerr << "invalid map file " << path << std::endl;
+        close();
+        return false;
+    }
+
+    header = h;
+    rows = reinterpret_cast<const uint64_t*>(h + 1);
+    if (!valid_tiles()) {
+        std::cerr << "invalid tiles in map file " << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool mapped_map::valid_tiles() const {
+    constexpr uint64_t nibbles = 0x1111111111111111ULL;
+    const int padding = header->row_words * 16 - header->x_size;
+    /*the padding nibbles at the end of every row have to be Unused*/
+    const uint64_t padding_mask =
+        padding == 0 ? 0 : ~0ULL << (4 * (16 - padding));
+
+    for (int y = 0; y < header->y_size; y++) {
+        const uint64_t* row = rows + y * header->row_words;
+        for (uint32_t w = 0; w < header->row_words; w++) {
+            /*a nibble is above DownStairs (6) if its bit 3 is set or its
+             * three lower bits are*/
+            uint64_t t = row[w];
+            if ((t >> 3 | (t & t >> 1 & t >> 2)) & nibbles)
+                return false;
+        }
+        if (row[header->row_words - 1] & padding_mask)
+            return false;
+    }
+    return true;
+}
+
+void mapped_map::close() {
+#ifdef _WIN32
+    if (view != nullptr)
+        UnmapViewOfFile(view);
+    if (mapping_handle != nullptr)
+        CloseHandle(mapping_handle);
+    if (file_handle != nullptr)
+        CloseHandle(file_handle);
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    if (view != nullptr)
+        munmap(view, view_size);
+    if (file_descriptor >= 0)
+        ::close(file_descriptor);
+    file_descriptor = -1;
+#endif
+    view = nullptr;
+    view_size = 0;
+    header = nullptr;
+    rows = nullptr;
+}
+
+Map mapped_map::to_map() const {
+    return Map(x_size(), y_size(), rows);
+}
@@ -0,0 +1,127 @@
+/*
+ * Null backend of the CHL engine: an engine without a window, sounds without
+ * a device, textures and fonts without a GPU. Everything is accepted and
+ * nothing is drawn or played, so the game simulation runs on machines that
+ * have neither, as fast as the CPU goes.
+ */
+#include "include/engine.hxx"
+#include "include/engine_internal.hxx"
+
+#include <chrono>
+#include <cstdlib>
+
+namespace CHL {
+
+/*the display mode the null window pretends to have*/
+static const int NULL_WIDTH = 1920;
+static const int NULL_HEIGHT = 1080;
+
+class null_engine : public engine {
+   public:
+    null_engine() : start(std::chrono::steady_clock::now()) {}
+
+    int CHL_init(int* width, int* height, int size, int fps) final {
+        FPS = fps;
+        t_size = size;
+        w_w = NULL_WIDTH;
+        w_h = NULL_HEIGHT;
+        *width = w_w;
+        *height = w_h;
+        return EXIT_SUCCESS;
+    }
+
+    void CHL_exit() final {}
+
+    float GL_time() final {
+        std::chrono::duration<float> t =
+            std::chrono::steady_clock::now() - start;
+        return t.count();
+    }
+
+    /*there is nobody to press anything*/
+    bool read_input(event&) final { return false; }
+    event_type get_event_type() final { return event_type::other; }
+    point get_mouse_pos(camera*) final { return point(0.0f, 0.0f); }
+    point get_window_params() final { return point(w_w, w_h); }
+
+    void set_virtual_world(int _w, int _h) final {
+        virtual_w = _w;
+        virtual_h = _h;
+    }
+
+    void GL_clear_color() final {}
+    void GL_swap_buffers() final {}
+    void add_object(instance*, camera*) final {}
+    void render(texture*, camera*, instance*) final {}
+    void add_to_buffer(const std::string&, instance*) final {}
+    void clear_buffer(const std::string&) final {}
+    void render(texture*, camera*, instance*, const std::string&) final {}
+    void render_text(const std::string&,
+                     font*,
+                     float,
+                     float,
+                     float,
+                     int,
+                     vec3) final {}
+    void render_ui(user_interface*) final {}
+    void render_light(light*, camera*) final {}
+
+   private:
+    std::chrono::steady_clock::time_point start;
+};
+
+engine* create_null_engine() {
+    return new null_engine();
+}
+
+/*sound procedures. Sources are never created, 0 is the null source*/
+void set_pos_s(uint32_t, const vec3&) {}
+void set_velocity_s(uint32_t, const vec3&) {}
+void set_volume_s(uint32_t, float) {}
+void pitch_s(uint32_t, float) {}
+vec3 get_listener() {
+    return vec3();
+}
+vec3 get_source_pos(uint32_t) {
+    return vec3();
+}
+
+void play_s(uint32_t) {}
+void play_always_s(uint32_t) {}
+void stop_s(uint32_t) {}
+void pause_s(uint32_t) {}
+
+float calculate_gain(gain_algorithm, uint32_t) {
+    return 0.0f;
+}
+
+void delete_source(uint32_t) {}
+void listener_update(const vec3&) {}
+
+uint32_t create_new_source(sound*, instance*) {
+    return 0;
+}
+
+sound::sound(const std::string&) : al_buffer(0), al_source(0) {}
+bool sound::load(const std::string&) {
+    return true;
+}
+void sound::play() {}
+void sound::play_always() {}
+void sound::stop() {}
+void sound::pause() {}
+void sound::volume(float) {}
+sound::~sound() {}
+
+texture::texture(const std::string&) : w(0), h(0), tex(0) {}
+texture::~texture() {}
+bool texture::load_texture(const std::string&) {
+    return true;
+}
+void texture::bind() {}
+void texture::unbind() {}
+
+font::font(std::string, uint32_t) {}
+font::~font() {}
+
+}    // namespace CHL
@@ -5,27 +5,18 @@
 #include <tuple>
 #include <cstdlib>
 #include <climits>
-#include <random>
 
 
 using namespace std;
 
-int ExploredNodes;
+thread_local int ExploredNodes;
 vector<int> Landmarks;
 vector<vector<int>> LD;
 
-typedef std::mt19937 RngT;
+typedef pcg32 RngT;
 
 int GetRandomInt(RngT& rng, int min, int max) {
-    return std::uniform_int_distribution<int>(min, max)(rng);
-}
-
-void convert2d_array(int** map, int* return_map, int x_size, int y_size) {
-    for (int y = 0; y < y_size; y++) {
-        for (int x = 0; x < x_size; x++) {
-            return_map[y * x_size + x] = !map[y][x];
-        }
-    }
+    return rng.range(min, max);
 }
 
 int BFSFindPath(const int nStartX,
@@ -269,10 +260,8 @@ end:
 void InitializeLandmarks(int k,
                          const int* pMap,
                          const int nMapWidth,
-                         const int nMapHeight) {
-    int Seed = rand();
-    auto rng = RngT(Seed);
-
+                         const int nMapHeight,
+                         RngT& rng) {
     vector<int> traversable;
     for (int i = 0; i < nMapWidth; i++)
         for (int j = 0; j < nMapHeight; j++)
@@ -412,10 +401,8 @@ end:
 void InitializeLandmarksDiag(int k,
                              const int* pMap,
                              const int nMapWidth,
-                             const int nMapHeight) {
-    int Seed = rand();
-    auto rng = RngT(Seed);
-
+                             const int nMapHeight,
+                             RngT& rng) {
     vector<int> traversable;
     for (int i = 0; i < nMapWidth; i++)
         for (int j = 0; j < nMapHeight; j++)
@@ -5,19 +5,18 @@
 #include "include/game_functions.hxx"
 #include "include/global_data.h"
 
-static float SHOOT_DELAY = 0.4f;
 static float SUPER_DELAY = 5.0f;
 static float BLINK_DELAY = 0.2f;
 static float DELAY_AFTER_BLINK = 0.2f;
 
 static float BLINKING_PATH = 32;
-static int HEALTH = 500;
 
 CHL::camera* main_camera;
 
 player::player(float x, float y, float z_index, int speed, int size)
     : life_form(x, y, z_index, speed, size) {
-    health = HEALTH;
+    health = tuning.hero_health;
+    kind = static_cast<int>(entity_kind::player);
 
     /*clear the array from dust*/
     for (int i = 0; i < 18; i++)
@@ -231,15 +230,12 @@ void player::blink_to(const CHL::point& p) {
 
 void player::fire() {
     if (shoot_delay <= 0.0f && !blinking) {
-        shoot_delay = SHOOT_DELAY;
+        shoot_delay = tuning.hero_shoot_delay;
         shooting_point = calculate_shooting_point(this, shooting_alpha);
-        bullets.insert(bullets.end(), new bullet(position.x + shooting_point.x,
-                                                 position.y + shooting_point.y,
-                                                 0.0f, 4, 2, 0, 2));
-        auto last_bullet = bullets.end() - 1;
-        (*last_bullet)->alpha = calculate_alpha_precision(shooting_alpha);
-        (*last_bullet)->speed = B_SPEED;
-        (*last_bullet)->creator = bullet_creator::player;
+        bullets.spawn(position.x + shooting_point.x,
+                      position.y + shooting_point.y,
+                      calculate_alpha_precision(shooting_alpha),
+                      tuning.bullet_speed, bullet_creator::player);
 
         CHL::set_pos_s(fire_source, CHL::vec3(position.x, position.y, 0.0f));
         CHL::play_s(fire_source);
@@ -251,12 +247,9 @@ void player::super_fire() {
         CHL::set_pos_s(fire_source, CHL::vec3(position.x, position.y, 0.0f));
         CHL::play_s(fire_source);
         for (int i = 0; i < 32; i++) {
-            bullets.insert(bullets.end(), new bullet(position.x + TILE_SIZE / 2,
-                                                     position.y - TILE_SIZE / 2,
-                                                     0.0f, 4, 2, 0, 2));
-            auto last_bullet = bullets.end() - 1;
-            (*last_bullet)->alpha = 2 * M_PI * i / 32.0f;
-            (*last_bullet)->speed = B_SPEED;
+            bullets.spawn(position.x + TILE_SIZE / 2,
+                          position.y - TILE_SIZE / 2, 2 * M_PI * i / 32.0f,
+                          tuning.bullet_speed, bullet_creator::allmighty);
             super_delay = SUPER_DELAY;
         }
     }
@@ -284,9 +277,9 @@ void player::move(float dt) {
         position.x += delta_x;
 
         /*checking the borders*/
-        if (position.x < 0 || position.x > VIRTUAL_WIDTH)
+        if (position.x < 0 || position.x > world_width)
             position.x -= delta_x;
-        if (position.y - TILE_SIZE < 0 || position.y > VIRTUAL_HEIGHT)
+        if (position.y - TILE_SIZE < 0 || position.y > world_height)
             position.y -= delta_y;
 
         if (blinking_path <= 0) {
@@ -296,19 +289,8 @@ void player::move(float dt) {
             delay_after_blink = DELAY_AFTER_BLINK;
             return;
         }
-        non_material_quads.insert(
-            non_material_quads.end(),
-            new CHL::instance(position.x, position.y, position.z_index,
-                              TILE_SIZE));
-
-        auto last_quad = non_material_quads.end() - 1;
-
-        /*setting the player's fade. Using the same texture setting for
-         * realistic effect*/
-        (*last_quad)->frames_in_texture = frames_in_texture;
-        (*last_quad)->tilesets_in_texture = tilesets_in_texture;
-        (*last_quad)->selected_tileset = selected_tileset;
-        (*last_quad)->selected_frame = selected_frame;
+        /*leaving the player's fade behind*/
+        effects.spawn_fade(this);
 
         // setting stereo sound effect
         CHL::set_pos_s(
@@ -354,9 +336,9 @@ void player::move(float dt) {
     position.x += delta_x;
 
     /*checking the borders*/
-    if (position.x < 0 || position.x > VIRTUAL_WIDTH)
+    if (position.x < 0 || position.x > world_width)
         position.x -= delta_x;
-    if (position.y - TILE_SIZE < 0 || position.y > VIRTUAL_HEIGHT)
+    if (position.y - TILE_SIZE < 0 || position.y > world_height)
         position.y -= delta_y;
 
     do_actions(this);
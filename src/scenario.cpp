@@ -0,0 +1,133 @@
+#include "include/scenario.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/*the whole value has to be read, "12abc" is not a number*/
+template <typename T>
+static bool read_value(const std::string& value, T& out) {
+    std::istringstream in(value);
+    T v;
+    if (!(in >> v) || !(in >> std::ws).eof())
+        return false;
+    out = v;
+    return true;
+}
+
+bool scenario::set(const std::string& key, const std::string& value) {
+    bool ok;
+    if (key == "map_width")
+        ok = read_value(value, map_width) && map_width >= MIN_MAP_WIDTH;
+    else if (key == "map_height")
+        ok = read_value(value, map_height) && map_height >= MIN_MAP_HEIGHT;
+    else if (key == "seed")
+        ok = read_value(value, seed);
+    else if (key == "enemies")
+        ok = read_value(value, enemies) && enemies >= 0;
+    else if (key == "duration")
+        ok = read_value(value, duration) && duration >= 0.0f;
+    else if (key == "threads")
+        ok = read_value(value, threads) && threads >= 0;
+    else if (key == "ai_lod")
+        ok = read_value(value, ai_lod);
+    else if (key == "endless")
+        ok = read_value(value, endless);
+    else if (key == "speed")
+        ok = read_value(value, tuning.speed);
+    else if (key == "bullet_speed")
+        ok = read_value(value, tuning.bullet_speed);
+    else if (key == "enemy_shoot_delay")
+        ok = read_value(value, tuning.enemy_shoot_delay);
+    else if (key == "hero_shoot_delay")
+        ok = read_value(value, tuning.hero_shoot_delay);
+    else if (key == "enemy_health")
+        ok = read_value(value, tuning.enemy_health);
+    else if (key == "hero_health")
+        ok = read_value(value, tuning.hero_health);
+    else {
+        std::cerr << "unknown scenario key " << key << std::endl;
+        return false;
+    }
+
+    if (!ok) {
+        std::cerr << "bad value " << value << " for " << key;
+        if (key == "map_width" || key == "map_height")
+            std::cerr << ", the map is at least " << MIN_MAP_WIDTH << "x"
+                      << MIN_MAP_HEIGHT << " tiles";
+        std::cerr << std::endl;
+    }
+    return ok;
+}
+
+bool scenario::load(const std::string& path) {
+    std::ifstream ifs(path.data());
+    if (!ifs) {
+        std::cerr << "cannot open scenario " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(ifs, line)) {
+        line = line.substr(0, line.find('#'));
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                std::cerr << "no '=' in scenario line " << line << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        std::string key, value;
+        std::istringstream(line.substr(0, eq)) >> key;
+        std::istringstream(line.substr(eq + 1)) >> value;
+        if (!set(key, value))
+            return false;
+    }
+    return true;
+}
+
+bool scenario::parse(int argc,
+                     char* argv[],
+                     std::vector<std::string>& positional) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            positional.push_back(arg);
+            continue;
+        }
+        if (i + 1 == argc) {
+            std::cerr << "no value for " << arg << std::endl;
+            return false;
+        }
+
+        std::string key = arg.substr(2);
+        std::string value = argv[++i];
+        if (key == "config" ? !load(value) : !set(key, value))
+            return false;
+    }
+    return true;
+}
+
+bool scenario::same_run(const scenario& other) const {
+    const game_tuning& a = tuning;
+    const game_tuning& b = other.tuning;
+    return map_width == other.map_width && map_height == other.map_height &&
+           seed == other.seed && enemies == other.enemies &&
+           ai_lod == other.ai_lod && endless == other.endless &&
+           a.speed == b.speed && a.bullet_speed == b.bullet_speed &&
+           a.enemy_shoot_delay == b.enemy_shoot_delay &&
+           a.hero_shoot_delay == b.hero_shoot_delay &&
+           a.enemy_health == b.enemy_health && a.hero_health == b.hero_health;
+}
+
+void scenario::print(std::ostream& out) const {
+    out << "scenario: map " << map_width << "x" << map_height << ", seed "
+        << seed << ", " << enemies << " enemies, duration " << duration
+        << " s, " << threads << " threads, ai lod " << ai_lod << ", endless "
+        << endless << ", speed " << tuning.speed << ", bullet speed "
+        << tuning.bullet_speed << ", shoot delay " << tuning.enemy_shoot_delay
+        << "/" << tuning.hero_shoot_delay << " s, health "
+        << tuning.enemy_health << "/" << tuning.hero_health << std::endl;
+}
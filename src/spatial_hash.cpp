@@ -0,0 +1,102 @@
+#include "include/spatial_hash.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "include/game_functions.hxx"
+
+spatial_hash::spatial_hash(float _cell_size, int table_size)
+    : cell_size(_cell_size),
+      mask(table_size - 1),
+      starts(table_size + 1, 0) {
+    assert(table_size > 0 && (table_size & (table_size - 1)) == 0);
+}
+
+uint32_t spatial_hash::slot_of(int cell_x, int cell_y) const {
+    uint32_t h = static_cast<uint32_t>(cell_x) * 73856093u ^
+                 static_cast<uint32_t>(cell_y) * 19349663u;
+    return h & mask;
+}
+
+void spatial_hash::cell_range(float left,
+                              float top,
+                              float right,
+                              float bottom,
+                              int& x0,
+                              int& y0,
+                              int& x1,
+                              int& y1) const {
+    x0 = static_cast<int>(std::floor(left / cell_size));
+    y0 = static_cast<int>(std::floor(top / cell_size));
+    x1 = static_cast<int>(std::floor(right / cell_size));
+    y1 = static_cast<int>(std::floor(bottom / cell_size));
+}
+
+void spatial_hash::clear() {
+    entries.clear();
+    items.clear();
+    std::fill(starts.begin(), starts.end(), 0);
+}
+
+void spatial_hash::add(int id,
+                       float left,
+                       float top,
+                       float right,
+                       float bottom) {
+    int x0, y0, x1, y1;
+    cell_range(left, top, right, bottom, x0, y0, x1, y1);
+    for (int y = y0; y <= y1; y++)
+        for (int x = x0; x <= x1; x++)
+            entries.push_back(entry{id, slot_of(x, y)});
+
+    if (id >= static_cast<int>(visited.size()))
+        visited.resize(id + 1, stamp);
+}
+
+void spatial_hash::add(int id, const CHL::instance* inst) {
+    float left, top, right, bottom;
+    collision_bounds(inst, left, top, right, bottom);
+    add(id, left, top, right, bottom);
+}
+
+void spatial_hash::build() {
+    /*counting sort of the entries by slot*/
+    for (const entry& e : entries)
+        starts[e.slot + 1]++;
+    for (size_t i = 1; i < starts.size(); i++)
+        starts[i] += starts[i - 1];
+
+    items.resize(entries.size());
+    std::vector<int> fill(starts.begin(), starts.end() - 1);
+    for (const entry& e : entries)
+        items[fill[e.slot]++] = e.id;
+}
+
+void spatial_hash::query(float left,
+                         float top,
+                         float right,
+                         float bottom,
+                         std::vector<int>& out) const {
+    out.clear();
+    if (++stamp == 0) {    // stamp wrapped, forget the old marks
+        std::fill(visited.begin(), visited.end(), 0);
+        stamp = 1;
+    }
+
+    int x0, y0, x1, y1;
+    cell_range(left, top, right, bottom, x0, y0, x1, y1);
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            uint32_t slot = slot_of(x, y);
+            for (int i = starts[slot]; i < starts[slot + 1]; i++) {
+                int id = items[i];
+                if (visited[id] != stamp) {
+                    visited[id] = stamp;
+                    out.push_back(id);
+                }
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
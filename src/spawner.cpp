@@ -0,0 +1,176 @@
+#include "include/spawner.h"
+
+#include <algorithm>
+
+spawner::spawner(const Map& map, const level& lvl)
+    : width(lvl.width),
+      height(lvl.height),
+      free_cells(lvl.free_cells),
+      walkable(lvl.walkable),
+      room_of(lvl.width * lvl.height, -1),
+      dist(lvl.width * lvl.height, -1),
+      taken(lvl.width * lvl.height, 0) {
+    /*rooms are connected areas of room floor, doors split them*/
+    std::vector<int> queue;
+    queue.reserve(width * height);
+    for (int start : free_cells) {
+        if (room_of[start] != -1 ||
+            map.GetCell(start % width, start / width) != Tile::DirtFloor)
+            continue;
+
+        queue.clear();
+        queue.push_back(start);
+        room_of[start] = room_count;
+        for (size_t head = 0; head < queue.size(); head++) {
+            int u = queue[head];
+            int x = u % width, y = u / width;
+            const int next[4][2] = {{x + 1, y}, {x - 1, y}, {x, y + 1},
+                                    {x, y - 1}};
+            for (auto& n : next) {
+                if (!map.IsXInBounds(n[0]) || !map.IsYInBounds(n[1]))
+                    continue;
+                int v = n[1] * width + n[0];
+                if (room_of[v] == -1 &&
+                    map.GetCell(n[0], n[1]) == Tile::DirtFloor) {
+                    room_of[v] = room_count;
+                    queue.push_back(v);
+                }
+            }
+        }
+        room_count++;
+    }
+}
+
+void spawner::set_hero(int tile_x, int tile_y) {
+    std::fill(dist.begin(), dist.end(), -1);
+
+    std::vector<int> queue;
+    queue.reserve(free_cells.size());
+
+    int start = tile_y * width + tile_x;
+    dist[start] = 0;
+    queue.push_back(start);
+    for (size_t head = 0; head < queue.size(); head++) {
+        int u = queue[head];
+        int x = u % width, y = u / width;
+        if (x + 1 < width && walkable[u + 1] && dist[u + 1] == -1) {
+            dist[u + 1] = dist[u] + 1;
+            queue.push_back(u + 1);
+        }
+        if (x > 0 && walkable[u - 1] && dist[u - 1] == -1) {
+            dist[u - 1] = dist[u] + 1;
+            queue.push_back(u - 1);
+        }
+        if (y + 1 < height && walkable[u + width] && dist[u + width] == -1) {
+            dist[u + width] = dist[u] + 1;
+            queue.push_back(u + width);
+        }
+        if (y > 0 && walkable[u - width] && dist[u - width] == -1) {
+            dist[u - width] = dist[u] + 1;
+            queue.push_back(u - width);
+        }
+    }
+
+    /*counting sort of the free cells by distance, the farthest first*/
+    int max_dist = 0;
+    for (int cell : free_cells)
+        max_dist = std::max(max_dist, dist[cell]);
+    std::vector<int> bucket_start(max_dist + 3, 0);
+    for (int cell : free_cells)
+        bucket_start[max_dist - dist[cell] + 1]++;
+    for (size_t i = 1; i < bucket_start.size(); i++)
+        bucket_start[i] += bucket_start[i - 1];
+    all_cells.resize(free_cells.size());
+    for (int cell : free_cells)
+        all_cells[bucket_start[max_dist - dist[cell]]++] = cell;
+
+    /*the order carries over to the room lists*/
+    room_cells.assign(room_count, std::vector<int>());
+    corridor_cells.clear();
+    all_room_cells.clear();
+    for (int cell : all_cells) {
+        if (room_of[cell] == -1) {
+            corridor_cells.push_back(cell);
+        } else {
+            room_cells[room_of[cell]].push_back(cell);
+            all_room_cells.push_back(cell);
+        }
+    }
+}
+
+size_t spawner::far_enough(const std::vector<int>& cells,
+                           int min_distance) const {
+    return std::partition_point(cells.begin(), cells.end(),
+                                [&](int cell) {
+                                    return dist[cell] >= min_distance;
+                                }) -
+           cells.begin();
+}
+
+std::vector<int> spawner::sample(int n,
+                                 const spawn_rules& rules,
+                                 pcg32& rng) {
+    std::vector<int> result;
+    if (n <= 0)
+        return result;
+
+    /*the candidates of a pool are the prefix [0, left) of its list*/
+    struct pool {
+        std::vector<int>* cells;
+        size_t left;
+    };
+    std::vector<pool> pools;
+    auto add_pool = [&](std::vector<int>& cells) {
+        size_t left = far_enough(cells, rules.min_distance);
+        if (left > 0)
+            pools.push_back(pool{&cells, left});
+    };
+    if (rules.different_rooms) {
+        for (std::vector<int>& cells : room_cells)
+            add_pool(cells);
+        if (rules.allow_corridors)
+            add_pool(corridor_cells);
+    } else {
+        add_pool(rules.allow_corridors ? all_cells : all_room_cells);
+    }
+    for (size_t i = pools.size(); i > 1; i--)
+        std::swap(pools[i - 1], pools[rng.below(i)]);
+
+    /*round robin over the pools, every pick is one step of a Fisher-Yates
+     * shuffle from the end of the prefix. The swaps are undone afterwards,
+     * so the lists stay sorted for the next call.*/
+    struct swap_record {
+        std::vector<int>* cells;
+        size_t a, b;
+    };
+    std::vector<swap_record> swaps;
+    result.reserve(n);
+    while (static_cast<int>(result.size()) < n && !pools.empty()) {
+        for (size_t i = 0;
+             i < pools.size() && static_cast<int>(result.size()) < n;) {
+            pool& p = pools[i];
+            /*cells taken by an earlier call are dropped on the way*/
+            int cell = -1;
+            while (p.left > 0 && cell < 0) {
+                size_t j = rng.below(p.left--);
+                std::swap((*p.cells)[j], (*p.cells)[p.left]);
+                swaps.push_back(swap_record{p.cells, j, p.left});
+                if (!taken[(*p.cells)[p.left]])
+                    cell = (*p.cells)[p.left];
+            }
+            if (cell < 0) {
+                pools.erase(pools.begin() + i);
+                continue;
+            }
+
+            taken[cell] = 1;
+            result.push_back(cell);
+            i++;
+        }
+    }
+
+    for (size_t i = swaps.size(); i > 0; i--)
+        std::swap((*swaps[i - 1].cells)[swaps[i - 1].a],
+                  (*swaps[i - 1].cells)[swaps[i - 1].b]);
+    return result;
+}
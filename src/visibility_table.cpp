@@ -0,0 +1,64 @@
+#include "include/visibility_table.h"
+
+#include <algorithm>
+#include <thread>
+
+static int passable_tiles(const line_of_sight& sight) {
+    int n = 0;
+    for (int y = 0; y < sight.get_height(); y++)
+        for (int x = 0; x < sight.get_width(); x++)
+            n += sight.passable(x, y);
+    return n;
+}
+
+size_t visibility_table::estimate(const line_of_sight& sight) {
+    size_t n = passable_tiles(sight);
+    size_t words = (n + 63) / 64;
+    return n * words * sizeof(uint64_t) +
+           sight.get_width() * sight.get_height() * sizeof(int);
+}
+
+void visibility_table::build(const line_of_sight& sight, int threads) {
+    width = sight.get_width();
+    int height = sight.get_height();
+
+    /*number the passable tiles, the bitsets are indexed by these numbers*/
+    std::vector<int> xs, ys;
+    index.assign(width * height, -1);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (!sight.passable(x, y))
+                continue;
+            index[y * width + x] = xs.size();
+            xs.push_back(x);
+            ys.push_back(y);
+        }
+    }
+    count = xs.size();
+    row_words = (count + 63) / 64;
+    bits.assign(static_cast<size_t>(count) * row_words, 0);
+
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, count));
+
+    /*every thread owns whole rows, so no word is written by two threads.
+     * Rows are dealt round robin, rooms and corridors are spread over the
+     * map and so is the work.*/
+    auto work = [&](int first) {
+        for (int from = first; from < count; from += threads) {
+            uint64_t* row = &bits[static_cast<size_t>(from) * row_words];
+            for (int to = 0; to < count; to++) {
+                if (sight.trace(xs[from], ys[from], xs[to], ys[to]))
+                    row[to / 64] |= uint64_t(1) << (to % 64);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.push_back(std::thread(work, t));
+    work(0);
+    for (std::thread& t : pool)
+        t.join();
+}
@@ -0,0 +1,378 @@
+#include "include/world.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "include/collision_solves.hxx"
+#include "include/enemy.h"
+#include "include/global_data.h"
+#include "include/spawner.h"
+
+/* no enemy spawns closer to the hero than this, in tiles of path */
+constexpr int MIN_SPAWN_DISTANCE = 4;
+
+/* enemies per job of the think pass, fewer are not worth a thread */
+constexpr size_t AI_GRAIN = 16;
+
+/* the enemies coming to the endless level start about as far as the edge of
+ * the middle chunk, out of the hero's sight */
+constexpr int ENDLESS_SPAWN_DISTANCE = CHUNK_SIZE / 2;
+
+/* the first window of the endless level has chunk (0, 0) in the middle */
+static const chunk_coord FIRST_WINDOW(-WINDOW_CHUNKS / 2, -WINDOW_CHUNKS / 2);
+
+/* enemies are hit by everybody else, the player only by enemies */
+static bool bullet_can_hit(bullet_creator creator, CHL::life_form* target) {
+    if (is_kind(target, entity_kind::enemy))
+        return creator != bullet_creator::enemy;
+    return is_kind(target, entity_kind::player) &&
+           creator == bullet_creator::enemy;
+}
+
+static level make_level(const Map& map, uint64_t seed, chunk_coord origin) {
+    /* the level draws first, every stream has to come from this seed */
+    random_streams.seed(seed);
+    level lvl;
+    build_level(map, lvl, origin.x * CHUNK_SIZE, origin.y * CHUNK_SIZE);
+    return lvl;
+}
+
+/* tile of the middle of the entity */
+static int tile_x(const CHL::life_form* lf) {
+    return static_cast<int>(std::floor(lf->position.x / TILE_SIZE + 0.5f));
+}
+static int tile_y(const CHL::life_form* lf) {
+    return static_cast<int>(std::floor(lf->position.y / TILE_SIZE - 0.5f));
+}
+
+world::world(const Map& map, uint64_t seed, int enemy_count, int threads)
+    : world(map, seed, enemy_count, threads, nullptr) {}
+
+world::world(const chunk_streamer& endless,
+             uint64_t seed,
+             int enemy_count,
+             int threads)
+    : world(endless.stitch(FIRST_WINDOW, WINDOW_CHUNKS),
+            seed,
+            enemy_count,
+            threads,
+            &endless) {}
+
+world::world(const Map& map,
+             uint64_t seed,
+             int _enemy_count,
+             int threads,
+             const chunk_streamer* _endless)
+    : lvl(make_level(map, seed,
+                     _endless != nullptr ? FIRST_WINDOW : chunk_coord())),
+      static_grid(lvl),
+      origin(_endless != nullptr ? FIRST_WINDOW : chunk_coord()),
+      endless(_endless),
+      enemy_count(_enemy_count),
+      spawn_rng(random_streams.stream(rng_system::spawns)),
+      entity_hash(2 * TILE_SIZE, 1024),
+      jobs(threads) {
+    using namespace CHL;
+    if (lvl.free_cells.empty())
+        throw std::runtime_error("no free cell for the hero on the " +
+                                 std::to_string(lvl.width) + "x" +
+                                 std::to_string(lvl.height) + " map");
+    bricks = lvl.bricks;
+    world_width = lvl.width * TILE_SIZE;
+    world_height = lvl.height * TILE_SIZE;
+
+    /* enemies look for the hero over the same map they walk on */
+    sight.set_map(lvl.walkable.data(), lvl.width, lvl.height);
+
+    /* with the precomputed table every visibility check is one bit test. The
+     * endless level is built again whenever the window moves, it traces. */
+    size_t visibility_bytes = visibility_table::estimate(sight);
+    if (endless != nullptr) {
+        std::cout << "visibility table skipped: the endless level moves"
+                  << std::endl;
+    } else if (visibility_bytes <= VISIBILITY_BUDGET) {
+        auto build_start = std::chrono::steady_clock::now();
+        visibility.build(sight);
+        sight.set_table(&visibility);
+        std::chrono::duration<float, std::milli> build_t =
+            std::chrono::steady_clock::now() - build_start;
+        std::cout << "visibility table: " << visibility.tiles() << " tiles, "
+                  << visibility.memory() / 1024 << " KB, built in "
+                  << build_t.count() << " ms" << std::endl;
+    } else {
+        std::cout << "visibility table skipped: " << visibility_bytes / 1024
+                  << " KB is over the budget" << std::endl;
+    }
+
+    /* the hero starts at the first free cell, of the middle chunk in the
+     * endless mode */
+    hero = new player(0.0f, 7.0f, 0.0f, tuning.speed, TILE_SIZE);
+    int hero_cell = lvl.free_cells.front();
+    if (endless != nullptr) {
+        const int first = WINDOW_CHUNKS / 2 * CHUNK_SIZE;
+        for (int cell : lvl.free_cells) {
+            int x = cell % lvl.width - first, y = cell / lvl.width - first;
+            if (x >= 0 && x < CHUNK_SIZE && y >= 0 && y < CHUNK_SIZE) {
+                hero_cell = cell;
+                break;
+            }
+        }
+    }
+    hero->position.x = (hero_cell % lvl.width) * TILE_SIZE;
+    hero->position.y = (hero_cell / lvl.width) * TILE_SIZE + TILE_SIZE;
+    /* bound here, a headless run and a replay steer the hero by these too */
+    hero->register_keys(event::up_pressed, event::down_pressed,
+                        event::left_pressed, event::right_pressed,
+                        event::left_mouse_pressed, event::button1_pressed,
+                        event::button2_pressed, event::turn_off);
+    entities.insert(hero);
+
+    spawn_enemies(map, enemy_count, hero_cell, spawn_rules());
+}
+
+void world::spawn_enemies(const Map& map,
+                          int count,
+                          int hero_cell,
+                          const spawn_rules& rules) {
+    /* place enemies away from the hero, one per room while rooms last. If the
+     * map is too small for that, fill the rest anywhere not too close. If even
+     * that is not enough, fewer enemies are placed. */
+    spawner spawns(map, lvl);
+    spawns.set_hero(hero_cell % lvl.width, hero_cell / lvl.width);
+
+    std::vector<int> spawn_cells = spawns.sample(count, rules, spawn_rng);
+    if (static_cast<int>(spawn_cells.size()) < count) {
+        spawn_rules anywhere;
+        anywhere.min_distance = MIN_SPAWN_DISTANCE;
+        anywhere.allow_corridors = true;
+        std::vector<int> rest =
+            spawns.sample(count - static_cast<int>(spawn_cells.size()),
+                          anywhere, spawn_rng);
+        spawn_cells.insert(spawn_cells.end(), rest.begin(), rest.end());
+    }
+    if (static_cast<int>(spawn_cells.size()) < count)
+        std::cerr << "only " << spawn_cells.size() << " of " << count
+                  << " enemies fit on the map " << lvl.width << "x"
+                  << lvl.height << std::endl;
+
+    for (int cell : spawn_cells) {
+        int x = cell % lvl.width;
+        int y = cell / lvl.width;
+        enemy* e = new enemy(x * TILE_SIZE, y * TILE_SIZE + TILE_SIZE - 2, 0.0f,
+                             tuning.speed, TILE_SIZE);
+        e->map = lvl.walkable.data();
+        e->map_width = lvl.width;
+        e->map_height = lvl.height;
+        ai_row r = enemy_states.row_of(e);
+        r.control.phase = next_phase++;
+        r.target.destination.x = hero->position.x;
+        r.target.destination.y = hero->position.y;
+        entities.insert(e);
+    }
+}
+
+void world::move_window(int dx, int dy) {
+    using namespace CHL;
+    origin = chunk_coord(origin.x + dx, origin.y + dy);
+    const point shift(-dx * CHUNK_SIZE * TILE_SIZE,
+                      -dy * CHUNK_SIZE * TILE_SIZE);
+
+    /* the chunks kept are at the same places of the new level, moved back by
+     * the shift. The grids keep their size, so whoever holds them reads the
+     * new level. */
+    for (instance* i : lvl.bricks)
+        delete i;
+    for (instance* i : lvl.floor)
+        delete i;
+    for (instance* i : lvl.wall_boxes)
+        delete i;
+    Map map = endless->stitch(origin, WINDOW_CHUNKS);
+    build_level(map, lvl, origin.x * CHUNK_SIZE, origin.y * CHUNK_SIZE);
+    bricks = lvl.bricks;
+    sight.set_map(lvl.walkable.data(), lvl.width, lvl.height);
+
+    hero->position.x += shift.x;
+    hero->position.y += shift.y;
+    hero->mouth_cursor.x += shift.x;
+    hero->mouth_cursor.y += shift.y;
+    hero->update_points();
+
+    /* the enemies left outside are gone, as if they were never there */
+    for (size_t i = 0; i < entities.size(); i++) {
+        if (!is_kind(entities[i], entity_kind::enemy))
+            continue;
+        enemy* e = static_cast<enemy*>(entities[i]);
+        e->translate(shift);
+        e->map = lvl.walkable.data();
+        int x = tile_x(e), y = tile_y(e);
+        if (x < 0 || y < 0 || x >= lvl.width || y >= lvl.height)
+            killed.push_back(entities.handle_of(i));
+    }
+    for (slot_handle h : killed) {
+        delete *entities.get(h);
+        entities.erase(h);
+    }
+    killed.clear();
+
+    bullets.translate(shift.x, shift.y);
+    effects.translate(shift.x, shift.y);
+
+    if (live_enemies < enemy_count) {
+        spawn_rules far;
+        far.min_distance = ENDLESS_SPAWN_DISTANCE;
+        spawn_enemies(map, enemy_count - live_enemies,
+                      tile_y(hero) * lvl.width + tile_x(hero), far);
+    }
+}
+
+void world::remove_dead() {
+    /* the dead were drawn for the last time, destroy them at once */
+    for (slot_handle h : killed) {
+        CHL::life_form** en = entities.get(h);
+        if (en == nullptr)
+            continue;
+        delete *en;
+        entities.erase(h);
+    }
+    if (!killed.empty() && live_enemies == 0 && endless == nullptr)
+        win = true;
+    killed.clear();
+}
+
+void world::step(float dt) {
+    using namespace CHL;
+    remove_dead();
+
+    /* the hero left the middle chunk of the endless level in the last step */
+    if (endless != nullptr) {
+        const int middle = WINDOW_CHUNKS / 2;
+        chunk_coord c = chunk_streamer::chunk_of(tile_x(hero), tile_y(hero));
+        if (c.x != middle || c.y != middle)
+            move_window(c.x - middle, c.y - middle);
+    }
+
+    prev_positions.resize(entities.size());
+    for (size_t i = 0; i < entities.size(); i++)
+        prev_positions[i] = point(entities[i]->position.x,
+                                  entities[i]->position.y);
+
+    double t = frame_stats::now();
+    hero->move(dt);
+
+    /* enemies think (or just coast, if they are far) and move on all the
+     * threads, one state after another. Then they change states, shoot and
+     * make noise one by one in the entities order, the walls push everybody
+     * back after. */
+    sight.new_frame();
+    thinking.clear();
+    for (life_form* lf : entities)
+        if (is_kind(lf, entity_kind::enemy))
+            thinking.push_back(static_cast<enemy*>(lf));
+    ai.schedule(enemy_states, point(hero->position.x, hero->position.y));
+    for (int s = 0; s < static_cast<int>(ai_state::count); s++) {
+        const ai_state state = static_cast<ai_state>(s);
+        jobs.parallel_for(enemy_states.bucket(state).size(), AI_GRAIN,
+                          [state, dt](size_t begin, size_t end) {
+                              enemy::think_bucket(state, begin, end, dt);
+                          });
+    }
+    enemy_states.apply_transitions(thinking);
+    for (enemy* e : thinking) {
+        e->apply();
+        point& d = enemy_states.row_of(e).target.destination;
+        d.x = hero->position.x + TILE_SIZE / 2;
+        d.y = hero->position.y - TILE_SIZE / 4;
+    }
+    double ai_end = frame_stats::now();
+    stats.add(subsystem::ai, ai_end - t);
+
+    /// player & enemy collisions to walls
+    for (life_form* lf : entities) {
+        lf->position.z_index = lf->position.y;
+        static_grid.query_walls(lf, near_walls);
+        for (instance* inst : near_walls) {
+            if (check_collision(lf, inst)) {
+                solve_dynamic_to_static_collision_fast(lf, inst, lf->delta_x,
+                                                       lf->delta_y);
+            }
+        }
+    }
+
+    hero->update_points();
+    t = frame_stats::now();
+    stats.add(subsystem::collision, t - ai_end);
+
+    /* broadphase: entities are hashed once per step by their collision boxes
+     * after the wall push, the boxes the bullets are tested against, so every
+     * bullet is tested only against the entities around it */
+    entity_hash.clear();
+    for (size_t i = 0; i < entities.size(); i++)
+        entity_hash.add(i, entities[i]);
+    entity_hash.build();
+
+    /* the bullets move first, then the way of this step is swept against
+     * the walls and the hashed entities where they are now. The hits are
+     * applied after the whole pool is tested. */
+    bullets.move(dt);
+    bullets.collide(static_grid, entity_hash, entities.data(), bullet_can_hit,
+                    hits);
+    for (const bullet_hit& h : hits) {
+        effects.spawn_explosion(h.point.x, h.point.y);
+
+        // walls and entities killed by one of previous bullets
+        if (h.target == nullptr || h.target->health <= 0)
+            continue;
+
+        if (is_kind(h.target, entity_kind::enemy)) {
+            if (--h.target->health <= 0) {
+                hero->blink_to(
+                    point(h.target->position.x, h.target->position.y));
+                hero->health = std::min(hero->health + 1, 5);
+                hud_health = hero->health;
+                killed.push_back(entities.handle_of(h.target_id));
+            }
+        } else {
+            hud_health--;
+            if (--h.target->health <= 0) {
+                loose = true;
+            }
+        }
+    }
+
+    double bullets_end = frame_stats::now();
+    stats.add(subsystem::bullets, bullets_end - t);
+
+    effects.animate(dt);
+    stats.add(subsystem::effects, frame_stats::now() - bullets_end);
+}
+
+void world::interpolate(float blend) {
+    /* nothing stepped yet */
+    if (prev_positions.size() != entities.size())
+        return;
+
+    positions.resize(entities.size());
+    for (size_t i = 0; i < entities.size(); i++) {
+        CHL::life_form* lf = entities[i];
+        positions[i] = CHL::point(lf->position.x, lf->position.y);
+        lf->position.x = prev_positions[i].x +
+                         (positions[i].x - prev_positions[i].x) * blend;
+        lf->position.y = prev_positions[i].y +
+                         (positions[i].y - prev_positions[i].y) * blend;
+        lf->update_data();
+    }
+}
+
+void world::restore() {
+    for (size_t i = 0; i < positions.size(); i++) {
+        CHL::life_form* lf = entities[i];
+        lf->position.x = positions[i].x;
+        lf->position.y = positions[i].y;
+        lf->update_data();
+    }
+    positions.clear();
+}